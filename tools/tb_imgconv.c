@@ -0,0 +1,293 @@
+/**
+ * tb_imgconv - convert images to "TBI1" blobs for the triplebuffer decoder
+ *
+ * Input is PAM (P7, RGB or RGB_ALPHA) or binary PPM (P6), 8 bit per
+ * channel. Convert PNGs first, e.g. `magick needle.png needle.pam`.
+ * Output is a C file with the blob and an lv_img_dsc_t named after the
+ * asset; enable IMG_DECODER_ENABLE in triplebuffer.c to draw it.
+ *
+ *   cc -O2 -o tb_imgconv tools/tb_imgconv.c
+ *   ./tb_imgconv [-a] [-r] [-s] [-n name] in.pam > name.c
+ *
+ *   -a  keep the alpha channel as A8 plane
+ *   -r  row-RLE for the color data (kept raw if that is smaller)
+ *   -s  swap RGB565 bytes, for LV_COLOR_16_SWAP = 1
+ *
+ * The flash footprint per asset is printed to stderr.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+// Must match tb_img_hdr_t in triplebuffer.h
+#define TB_IMG_MAGIC        0x31494254u
+#define TB_IMG_F_ALPHA      0x01
+#define TB_IMG_F_RLE        0x02
+#define TB_IMG_F_SWAP       0x04
+#define TB_IMG_HDR_SIZE     32
+#define TB_IMG_MAX_DIM      2047    // lv_img_header_t has 11 bit w / h
+
+// Must match rle_encode in triplebuffer.c
+#define RLE_MAX_RUN     32768
+
+typedef struct {
+    int      w, h;
+    int      has_alpha;
+    uint8_t *rgba;          // w * h * 4
+} image_t;
+
+/* ============================================================
+ * Input
+ * ============================================================ */
+
+static int read_token(FILE *f, char *buf, size_t cap)
+{
+    int c;
+    size_t n = 0;
+    // Skip whitespace and comments
+    for (;;) {
+        c = fgetc(f);
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(f);
+        } else if (!isspace(c)) {
+            break;
+        }
+    }
+    while (c != EOF && !isspace(c) && n + 1 < cap) {
+        buf[n++] = (char)c;
+        c = fgetc(f);
+    }
+    buf[n] = '\0';
+    return n > 0;
+}
+
+static int read_image(const char *path, image_t *img)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    char tok[32];
+    int depth = 3, maxval = 0;
+    img->w = img->h = 0;
+    read_token(f, tok, sizeof(tok));
+    if (strcmp(tok, "P6") == 0) {
+        read_token(f, tok, sizeof(tok)); img->w = atoi(tok);
+        read_token(f, tok, sizeof(tok)); img->h = atoi(tok);
+        read_token(f, tok, sizeof(tok)); maxval = atoi(tok);
+    } else if (strcmp(tok, "P7") == 0) {
+        while (read_token(f, tok, sizeof(tok)) && strcmp(tok, "ENDHDR") != 0) {
+            char val[32];
+            if (!read_token(f, val, sizeof(val))) break;
+            if (strcmp(tok, "WIDTH") == 0) img->w = atoi(val);
+            else if (strcmp(tok, "HEIGHT") == 0) img->h = atoi(val);
+            else if (strcmp(tok, "DEPTH") == 0) depth = atoi(val);
+            else if (strcmp(tok, "MAXVAL") == 0) maxval = atoi(val);
+        }
+    } else {
+        fprintf(stderr, "%s: not a P6 or P7 file\n", path);
+        fclose(f);
+        return -1;
+    }
+    if (maxval != 255 || (depth != 3 && depth != 4) ||
+        img->w <= 0 || img->h <= 0 || img->w > TB_IMG_MAX_DIM || img->h > TB_IMG_MAX_DIM) {
+        fprintf(stderr, "%s: unsupported format (need 8 bit RGB/RGBA, max. %d px)\n",
+                path, TB_IMG_MAX_DIM);
+        fclose(f);
+        return -1;
+    }
+
+    size_t px = (size_t)img->w * img->h;
+    uint8_t *raw = malloc(px * depth);
+    img->rgba = malloc(px * 4);
+    if (!raw || !img->rgba || fread(raw, depth, px, f) != px) {
+        fprintf(stderr, "%s: truncated\n", path);
+        free(raw);
+        fclose(f);
+        return -1;
+    }
+    for (size_t i = 0; i < px; i++) {
+        memcpy(&img->rgba[i * 4], &raw[i * depth], 3);
+        img->rgba[i * 4 + 3] = (depth == 4) ? raw[i * depth + 3] : 255;
+    }
+    img->has_alpha = (depth == 4);
+    free(raw);
+    fclose(f);
+    return 0;
+}
+
+/* ============================================================
+ * Encoding
+ * ============================================================ */
+
+static uint16_t to_rgb565(const uint8_t *p)
+{
+    uint16_t r = (p[0] * 31 + 127) / 255;
+    uint16_t g = (p[1] * 63 + 127) / 255;
+    uint16_t b = (p[2] * 31 + 127) / 255;
+    return (r << 11) | (g << 5) | b;
+}
+
+/**
+ * Same token stream as rle_encode in triplebuffer.c, one row at a time
+ * so runs never cross a row. Returns the number of 16-bit words.
+ */
+static size_t rle_encode_row(const uint16_t *src, int w, uint16_t *o)
+{
+    uint16_t *start = o;
+    uint16_t *lit_hdr = NULL;
+    int x = 0;
+
+    while (x < w) {
+        int run = 1;
+        while (x + run < w && src[x + run] == src[x] && run < RLE_MAX_RUN) run++;
+        if (run >= 3) {
+            *o++ = 0x8000 | (run - 1);
+            *o++ = src[x];
+            lit_hdr = NULL;
+        } else {
+            for (int i = 0; i < run; i++) {
+                if (!lit_hdr || (*lit_hdr & 0x7FFF) == RLE_MAX_RUN - 1) {
+                    lit_hdr = o++;
+                    *lit_hdr = 0xFFFF;
+                }
+                (*lit_hdr)++;
+                *o++ = src[x];
+            }
+        }
+        x += run;
+    }
+    return o - start;
+}
+
+static void put_u16(uint8_t *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void put_u32(uint8_t *p, uint32_t v) { put_u16(p, v & 0xFFFF); put_u16(p + 2, v >> 16); }
+
+/* ============================================================
+ * Main
+ * ============================================================ */
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: tb_imgconv [-a] [-r] [-s] [-n name] in.pam|in.ppm > out.c\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int keep_alpha = 0, rle = 0, swap = 0;
+    const char *name = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "arsn:")) != -1) {
+        switch (opt) {
+        case 'a': keep_alpha = 1; break;
+        case 'r': rle = 1; break;
+        case 's': swap = 1; break;
+        case 'n': name = optarg; break;
+        default:  usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+    const char *path = argv[optind];
+
+    // Default name: file name without directory and extension
+    char def_name[64];
+    if (!name) {
+        const char *base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        snprintf(def_name, sizeof(def_name), "%s", base);
+        char *dot = strchr(def_name, '.');
+        if (dot) *dot = '\0';
+        for (char *c = def_name; *c; c++) {
+            if (!isalnum((unsigned char)*c)) *c = '_';
+        }
+        name = def_name;
+    }
+
+    image_t img;
+    if (read_image(path, &img) != 0) return 1;
+    if (keep_alpha && !img.has_alpha) {
+        fprintf(stderr, "%s: no alpha channel, -a ignored\n", path);
+        keep_alpha = 0;
+    }
+
+    const size_t px = (size_t)img.w * img.h;
+    uint16_t *color = malloc(px * 2);
+    // Worst case per row: one literal header per RLE_MAX_RUN pixels
+    uint16_t *packed = malloc(px * 2 + (size_t)img.h * ((img.w / RLE_MAX_RUN + 1) * 2));
+    for (size_t i = 0; i < px; i++) {
+        uint16_t c = to_rgb565(&img.rgba[i * 4]);
+        color[i] = swap ? (uint16_t)((c << 8) | (c >> 8)) : c;
+    }
+
+    // Color data: row-RLE if asked for and smaller, else raw
+    const uint16_t *data = color;
+    size_t color_len = px * 2;
+    if (rle) {
+        size_t words = 0;
+        for (int y = 0; y < img.h; y++) {
+            words += rle_encode_row(color + (size_t)y * img.w, img.w, packed + words);
+        }
+        if (words * 2 < color_len) {
+            data = packed;
+            color_len = words * 2;
+        } else {
+            fprintf(stderr, "%s: RLE does not pay off, storing raw\n", path);
+            rle = 0;
+        }
+    }
+
+    uint8_t hdr[TB_IMG_HDR_SIZE] = { 0 };
+    put_u32(hdr, TB_IMG_MAGIC);
+    put_u16(hdr + 4, img.w);
+    put_u16(hdr + 6, img.h);
+    put_u32(hdr + 8, color_len);
+    hdr[12] = (keep_alpha ? TB_IMG_F_ALPHA : 0) | (rle ? TB_IMG_F_RLE : 0) | (swap ? TB_IMG_F_SWAP : 0);
+    size_t name_len = strlen(name);
+    memcpy(hdr + 16, name, (name_len < 16) ? name_len : 16);     // Not terminated at 16 chars
+
+    size_t blob_len = TB_IMG_HDR_SIZE + color_len + (keep_alpha ? px : 0);
+    uint8_t *blob = malloc(blob_len);
+    memcpy(blob, hdr, TB_IMG_HDR_SIZE);
+    for (size_t i = 0; i < color_len / 2; i++) {
+        put_u16(blob + TB_IMG_HDR_SIZE + i * 2, data[i]);
+    }
+    if (keep_alpha) {
+        for (size_t i = 0; i < px; i++) {
+            blob[TB_IMG_HDR_SIZE + color_len + i] = img.rgba[i * 4 + 3];
+        }
+    }
+
+    printf("/* Generated by tb_imgconv from %s: %dx%d%s%s%s */\n\n",
+           path, img.w, img.h, keep_alpha ? ", alpha" : "", rle ? ", RLE" : "", swap ? ", swapped" : "");
+    printf("#include \"lvgl.h\"\n\n");
+    printf("static const uint8_t %s_blob[%zu] __attribute__((aligned(4))) = {", name, blob_len);
+    for (size_t i = 0; i < blob_len; i++) {
+        printf("%s0x%02x,", (i % 16) ? " " : "\n    ", blob[i]);
+    }
+    printf("\n};\n\n");
+    printf("const lv_img_dsc_t %s = {\n", name);
+    printf("    .header.cf = LV_IMG_CF_USER_ENCODED_0,\n");
+    printf("    .header.w = %d,\n", img.w);
+    printf("    .header.h = %d,\n", img.h);
+    printf("    .data_size = sizeof(%s_blob),\n", name);
+    printf("    .data = %s_blob,\n", name);
+    printf("};\n");
+
+    // What LVGL would need as plain TRUE_COLOR(_ALPHA) array
+    size_t plain = px * (keep_alpha ? 3 : 2);
+    fprintf(stderr, "%s: %dx%d, %zu B flash (%.0f%% of %zu B %s)\n",
+            name, img.w, img.h, blob_len, 100.0 * blob_len / plain, plain,
+            keep_alpha ? "TRUE_COLOR_ALPHA" : "TRUE_COLOR");
+
+    free(blob);
+    free(packed);
+    free(color);
+    free(img.rgba);
+    return 0;
+}
@@ -18,16 +18,33 @@
  */
 
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_check.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_rgb.h"
-#include "esp_async_memcpy.h"
 #include "esp_heap_caps.h"
 #include "esp_cache.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "multi_heap.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_partition.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_rom_crc.h"
+#include "esp_private/cache_utils.h"
+#include "esp_private/gdma.h"
+#include "hal/dma_types.h"
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
 #include "lvgl.h"
+#include "triplebuffer.h"
 
 static const char *TAG = "triple_buf";
 
@@ -40,6 +57,200 @@ static const char *TAG = "triple_buf";
 #define FB_SIZE         (DISP_WIDTH * DISP_HEIGHT * DISP_BPP)  // ~1 MB
 #define FB_ALIGN        64      // Cache-line alignment for PSRAM DMA
 
+_Static_assert(DISP_WIDTH == TB_DISP_WIDTH && DISP_HEIGHT == TB_DISP_HEIGHT,
+               "triplebuffer.h resolution out of sync");
+
+// Scenario benchmark instead of the demo UI (see run_benchmark)
+#ifndef BENCH_ENABLE
+#define BENCH_ENABLE        0
+#endif
+#define BENCH_SCENE_MS      10000   // Duration of each scene
+#define BENCH_MAX_FRAMES    2048    // Frame time samples kept per scene
+#define BENCH_SAVE_BASELINE 0       // 1 = overwrite the stored baseline with this run
+
+// Flush stream record/replay via the "flushlog" data partition (see flush_log_*)
+#ifndef FLUSH_RECORD_ENABLE
+#define FLUSH_RECORD_ENABLE 0       // Record lvgl_flush_cb, save when stopped or full
+#endif
+#ifndef FLUSH_REPLAY_ENABLE
+#define FLUSH_REPLAY_ENABLE 0       // Replay the stored log instead of running LVGL
+#endif
+#define FLUSH_LOG_SIZE      (2 * 1024 * 1024)   // PSRAM record buffer
+#define FLUSH_LOG_MAX_MS    30000   // Save after this long (0 = only when stopped or full)
+
+// Pipeline trace (render / flush / GDMA / swap / vsync), dumped as Chrome JSON
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        0
+#endif
+#define TRACE_EVENTS        8192    // Ring size, 8 bytes per event
+#define TRACE_DUMP_MS       5000    // Dump once after this many ms of runtime
+
+// Cycle-counter profiler for hot paths (PROF_SCOPE / PROF_RECORD)
+#ifndef PROF_ENABLE
+#define PROF_ENABLE         0
+#endif
+#define PROF_HIST_BUCKETS   20      // log2(cycles) histogram, last bucket = overflow
+
+// Performance HUD drawn into the outgoing frame, bypassing LVGL
+#ifndef HUD_ENABLE
+#define HUD_ENABLE          0
+#endif
+#define HUD_X               0
+#define HUD_Y               0
+#define HUD_W               128     // HUD_W * HUD_H pixels are written per frame
+#define HUD_H               40
+
+// Damage visualization: tint flushed areas, count damage per 16x16 tile
+#ifndef DAMAGE_VIS_ENABLE
+#define DAMAGE_VIS_ENABLE   0
+#endif
+#define DAMAGE_MAX_AREAS    32      // Flush areas tracked per frame
+#define DAMAGE_VIS_FRAMES   4       // Frames a tint takes to fade out
+#define DAMAGE_TILE         16
+
+// Render critical areas first, defer low-priority ones over budget (see tb_damage_set_priority)
+#ifndef DAMAGE_SCHED_ENABLE
+#define DAMAGE_SCHED_ENABLE 0
+#endif
+#define DAMAGE_BUDGET_US    33000   // Render + copy per frame
+#define DAMAGE_MAX_HINTS    16      // Objects with a priority
+#define DAMAGE_DEFER_MAX    4       // Frames a deferrable area waits at most
+
+// Remote view: keyframe + damaged rectangles, RLE encoded, to a byte sink
+#ifndef STREAM_ENABLE
+#define STREAM_ENABLE       0
+#endif
+
+// LVGL memory backend (needs LV_MEM_CUSTOM = 1 in lv_conf.h, see tb_lv_malloc)
+#ifndef LVMEM_ENABLE
+#define LVMEM_ENABLE        0
+#endif
+#define LVMEM_HEAP_SIZE     (64 * 1024)     // Internal TLSF region for mid-size objects
+#define LVMEM_PSRAM_MIN     (8 * 1024)      // From this size on: PSRAM (image data)
+
+// Decoded A8 glyph cache in internal RAM (see tb_glyph_cache_font)
+#ifndef GLYPH_CACHE_ENABLE
+#define GLYPH_CACHE_ENABLE  0
+#endif
+#define GLYPH_SLOTS         64
+#define GLYPH_SLOT_BYTES    640     // A8 box_w * box_h, fits ~25x25 px glyphs
+#define GLYPH_MAX_FONTS     4
+
+// Front Buffer snapshot in the "fbsnap" partition for instant wake from deep sleep
+#ifndef SNAPSHOT_ENABLE
+#define SNAPSHOT_ENABLE     0
+#endif
+
+// LVGL image decoder for tools/tb_imgconv.c blobs
+#ifndef IMG_DECODER_ENABLE
+#define IMG_DECODER_ENABLE  0
+#endif
+#define IMG_MAX_ASSETS      16      // Assets with their own stats entry
+
+// Profile-driven placement of registered images (see tb_asset_register)
+#ifndef ASSET_ENABLE
+#define ASSET_ENABLE        0
+#endif
+#define ASSET_MAX           32
+#define ASSET_IRAM_BUDGET   (64 * 1024)     // Hottest assets, copied to internal RAM
+#define ASSET_PSRAM_BUDGET  (1024 * 1024)   // Next ones, copied to PSRAM
+
+// Decoded-image cache in the PSRAM left after the framebuffers
+#ifndef IMGC_ENABLE
+#define IMGC_ENABLE         0
+#endif
+#define IMGC_BUDGET         (2 * 1024 * 1024)   // Upper limit for decoded pixels
+#define IMGC_PSRAM_RESERVE  (512 * 1024)        // Always left free for everything else
+#define IMGC_MAX_ENTRIES    48
+
+// Scanout through IRAM bounce buffers that survive flash writes (see tb_flash_op_begin)
+#ifndef FLASH_SAFE_ENABLE
+#define FLASH_SAFE_ENABLE   0       // Needs CONFIG_LCD_RGB_ISR_IRAM_SAFE=y
+#endif
+
+// Hot band of rows kept in internal RAM for all three buffers (see fb_row)
+#ifndef HYBRID_FB_ENABLE
+#define HYBRID_FB_ENABLE    0
+#endif
+#define HYBRID_BAND_Y       344     // First row, default: around the pointer hub
+#define HYBRID_BAND_LINES   32      // 3 x 45 KB internal RAM
+_Static_assert(HYBRID_BAND_Y + HYBRID_BAND_LINES <= DISP_HEIGHT, "band outside the frame");
+
+// Both modes scan out through bounce buffers refilled by lcd_bounce_fill_cb
+#define SCANOUT_BOUNCE      (FLASH_SAFE_ENABLE || HYBRID_FB_ENABLE)
+#define BOUNCE_LINES        10      // Lines per bounce buffer
+
+_Static_assert(DISP_HEIGHT % BOUNCE_LINES == 0, "the bounce buffers must tile the frame");
+
+// Panel timing ranges (from the panel datasheet) for the planner (plan_timing)
+#define PANEL_PCLK_MIN_HZ   (12 * 1000 * 1000)
+#define PANEL_PCLK_MAX_HZ   (30 * 1000 * 1000)
+#define PANEL_HPW_MIN       2
+#define PANEL_HBP_MIN       20
+#define PANEL_HFP_MIN       40
+#define PANEL_VPW_MIN       2
+#define PANEL_VBP_MIN       8
+#define PANEL_VFP_MIN       20
+#define PANEL_VFP_MAX       200     // Only the vertical front porch is stretched
+#define PANEL_TARGET_HZ     40      // Refresh rate to aim for
+
+// PSRAM and pipeline assumptions for the bandwidth budget
+#ifdef CONFIG_SPIRAM_SPEED
+#define PSRAM_CLK_MHZ       CONFIG_SPIRAM_SPEED
+#else
+#define PSRAM_CLK_MHZ       80
+#endif
+#ifdef CONFIG_SPIRAM_MODE_QUAD
+#define PSRAM_BITS_PER_CLK  4       // Quad SPI, SDR
+#else
+#define PSRAM_BITS_PER_CLK  16      // Octal SPI, DDR
+#endif
+#define PSRAM_EFFICIENCY_PCT 70     // Usable share of the raw rate (commands, refresh)
+#define PLAN_PIPELINE_FPS   20      // Full-frame presents that must fit besides scanout
+#define PLAN_SCANOUT_PEAK_PCT 50    // Above this share of PSRAM, scan out via bounce buffers
+#define PLAN_MAX_STALL_US   300     // PSRAM stall the bounce buffers must bridge
+#define PLAN_BOUNCE_RAM_MAX (64 * 1024) // Internal RAM for both bounce buffers, at most
+
+// Measure copy crossover, strip height and bounce size at first boot (see calib_*)
+#ifndef CALIB_ENABLE
+#define CALIB_ENABLE        0
+#endif
+#define CALIB_VERSION       1       // Bump when the measurements change, forces a rerun
+#define CALIB_RUNS          4       // Best of n per measurement
+#define CALIB_STALL_PCT     90      // Stall = this percentile of the copy times - fastest
+#define CALIB_COPY_MAX      (256 * 1024)    // Largest size tried for the CPU/GDMA crossover
+#define CALIB_STRIP_MIN     10      // Render strip heights tried, in lines
+#define CALIB_STRIP_MAX     120
+#define CALIB_STRIP_STEP    10
+#define CALIB_STRIP_TOL_PCT 3       // Smaller strip if at most this much slower
+#define CALIB_RAM_RESERVE   (48 * 1024)     // Internal RAM the render buffer must leave
+
+// Interrupt-driven touch (FT5x06 family on I2C) as LVGL pointer (see touch_task)
+#ifndef TOUCH_ENABLE
+#define TOUCH_ENABLE        0
+#endif
+#define TOUCH_I2C_SDA       -1      // TODO: Your pins (-1 = replay only)
+#define TOUCH_I2C_SCL       -1
+#define TOUCH_INT_GPIO      -1
+#define TOUCH_I2C_ADDR      0x38
+#define TOUCH_QUEUE_LEN     64      // Events, power of two
+#define TOUCH_RELEASE_MS    40      // Re-read while pressed, in case the lift edge is lost
+#define TOUCH_PREDICT_MAX_US 40000  // Longest extrapolation ahead of the last sample
+#define TOUCH_PREDICT_GAP_US 50000  // Samples further apart: finger stopped, no velocity
+
+// Tiny frames go straight into the Front Buffer during vblank (see vblank_patch)
+#ifndef VBLANK_PATCH_ENABLE
+#define VBLANK_PATCH_ENABLE 0
+#endif
+#define VBLANK_PATCH_MAX_PX 4096    // Frames with more damage take the full pipeline
+#define VBLANK_PATCH_LEAD_LINES 2   // LCD_CAM read-ahead without bounce buffers
+
+// GDMA copy watchdog (see gdma_copy_buffer)
+#define GDMA_DESC_BYTES     4080    // Per descriptor: below 4 KB, multiple of the PSRAM burst
+#define GDMA_WDT_FACTOR     4       // Deadline = expected copy time x factor ...
+#define GDMA_WDT_SLACK_US   2000    // ... + slack
+#define GDMA_WDT_MIN_BW     (20 * 1000 * 1000)  // Rate assumed before calibration and plan
+
 /* ============================================================
  * Global Variables
  * ============================================================ */
@@ -49,30 +260,470 @@ static uint8_t *work_buf  = NULL;   // LVGL renders into this
 static uint8_t *front_buf = NULL;   // LCD_CAM reads from this
 static uint8_t *back_buf  = NULL;   // GDMA copy target, then swap
 
-// GDMA async memcpy
-static async_memcpy_handle_t s_mcp_handle = NULL;
+// GDMA memory-to-memory channel pair
+static gdma_channel_handle_t s_gdma_tx = NULL;      // Reads the source
+static gdma_channel_handle_t s_gdma_rx = NULL;      // Writes the destination
+static bool                  s_gdma_ok = false;     // false = copies by CPU
 static SemaphoreHandle_t     s_copy_done_sem = NULL;
 static volatile bool         s_copy_in_progress = false;
+static volatile bool         s_copy_armed = false;  // The current copy may signal
+static tb_gdma_stats_t       s_gdma;
 
 // LCD Panel Handle
 static esp_lcd_panel_handle_t s_panel_handle = NULL;
+static volatile uint32_t      s_vsync_count = 0;    // Frames scanned out
+static volatile uint32_t      s_vsync_us = 0;       // Start of the last frame (wraps)
 
 // LVGL Display
 static lv_disp_drv_t  s_disp_drv;
 static lv_disp_draw_buf_t s_draw_buf;
 
+// Pipeline statistics, only written from the LVGL task
+typedef struct {
+    uint32_t frames;            // Presented frames (swaps and vblank patches)
+    uint64_t flush_bytes;       // CPU copies render_buf → work_buf
+    uint64_t copy_bytes;        // GDMA copies work → back
+    uint64_t copy_wait_us;      // Time blocked on s_copy_done_sem
+    uint64_t band_bytes;        // Flush + copy traffic kept in the SRAM band
+    int64_t  last_present_us;   // Timestamp of the last swap
+} pipeline_stats_t;
+static pipeline_stats_t s_stats;
+
+// Tuned by the boot calibration (CALIB_ENABLE), zero = compile-time default
+static tb_calib_t s_calib;
+
+// Panel timing and PSRAM budget (plan_timing)
+static tb_timing_plan_t s_plan;
+
+// Areas flushed during the current frame (reset after each present)
+typedef struct {
+    lv_area_t areas[DAMAGE_MAX_AREAS];
+    uint32_t  count;
+    uint32_t  pixels;           // Sum of the flushed strip sizes
+} frame_damage_t;
+static frame_damage_t s_damage;
+
+#if BENCH_ENABLE
+static void bench_on_present(int64_t now_us);
+#endif
+#if TOUCH_ENABLE
+static void touch_on_present(int64_t now_us);
+#endif
+#if DAMAGE_SCHED_ENABLE
+static void damage_sched_on_present(int64_t copy_us, int64_t now_us);
+#endif
+#if VBLANK_PATCH_ENABLE
+static bool vblank_patch(void);
+#endif
+
+/* ============================================================
+ * Pipeline Trace
+ * ============================================================ */
+
+/*
+ * Compact binary event ring (8 bytes per event), written lock-free from
+ * tasks and ISRs on both cores. trace_dump_json() converts it into Chrome
+ * trace JSON (chrome://tracing, ui.perfetto.dev) with one track per core
+ * plus separate GDMA and LCD tracks:
+ *
+ *   idf.py monitor | sed -n '/^TRACE_BEGIN/,/^TRACE_END/p' | sed '1d;$d' > trace.json
+ */
+typedef enum {
+    TRACE_RENDER_BEGIN,     // LVGL starts refreshing a frame
+    TRACE_RENDER_END,       // Last strip rendered
+    TRACE_FLUSH_BEGIN,      // lvgl_flush_cb, arg = strip height
+    TRACE_FLUSH_END,
+    TRACE_GDMA_START,       // arg = size in KB
+    TRACE_GDMA_END,
+    TRACE_SWAP,
+    TRACE_VSYNC,
+} trace_type_t;
+
+#if TRACE_ENABLE
+
+typedef struct {
+    uint32_t t_us;
+    uint8_t  type;
+    uint8_t  core;
+    uint16_t arg;
+} trace_evt_t;
+
+static trace_evt_t s_trace[TRACE_EVENTS];
+static uint32_t    s_trace_head = 0;
+static volatile bool s_trace_stopped = false;
+
+static IRAM_ATTR void trace_event(trace_type_t type, uint16_t arg)
+{
+    if (s_trace_stopped) return;
+    uint32_t i = __atomic_fetch_add(&s_trace_head, 1, __ATOMIC_RELAXED);
+    trace_evt_t *e = &s_trace[i % TRACE_EVENTS];
+    e->t_us = (uint32_t)esp_timer_get_time();
+    e->type = type;
+    e->core = xPortGetCoreID();
+    e->arg = arg;
+}
+
+#define TRACE(type, arg)    trace_event((type), (arg))
+
+/**
+ * Stop recording and print the ring as Chrome trace JSON
+ */
+static void trace_dump_json(void)
+{
+    static const char *const names[] = {
+        [TRACE_RENDER_BEGIN] = "render", [TRACE_RENDER_END] = "render",
+        [TRACE_FLUSH_BEGIN]  = "flush",  [TRACE_FLUSH_END]  = "flush",
+        [TRACE_GDMA_START]   = "copy",   [TRACE_GDMA_END]   = "copy",
+        [TRACE_SWAP]         = "swap",   [TRACE_VSYNC]      = "vsync",
+    };
+    enum { TID_GDMA = 10, TID_LCD = 11 };
+
+    s_trace_stopped = true;
+    uint32_t head = s_trace_head;
+    uint32_t n = (head < TRACE_EVENTS) ? head : TRACE_EVENTS;
+
+    printf("TRACE_BEGIN\n{\"traceEvents\":[\n");
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"core 0\"}},\n");
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"core 1\"}},\n");
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"GDMA\"}},\n", TID_GDMA);
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"LCD_CAM\"}}", TID_LCD);
+
+    for (uint32_t k = head - n; k != head; k++) {
+        const trace_evt_t *e = &s_trace[k % TRACE_EVENTS];
+        int tid = e->core;
+        const char *ph;
+        switch (e->type) {
+        case TRACE_RENDER_BEGIN:
+        case TRACE_FLUSH_BEGIN:  ph = "B"; break;
+        case TRACE_RENDER_END:
+        case TRACE_FLUSH_END:    ph = "E"; break;
+        case TRACE_GDMA_START:   ph = "B"; tid = TID_GDMA; break;
+        case TRACE_GDMA_END:     ph = "E"; tid = TID_GDMA; break;
+        case TRACE_VSYNC:        ph = "i"; tid = TID_LCD; break;
+        default:                 ph = "i"; break;
+        }
+        printf(",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%u,\"pid\":0,\"tid\":%d%s,\"args\":{\"arg\":%u}}",
+               names[e->type], ph, (unsigned)e->t_us, tid,
+               (ph[0] == 'i') ? ",\"s\":\"t\"" : "", (unsigned)e->arg);
+    }
+    printf("\n]}\nTRACE_END\n");
+    ESP_LOGI(TAG, "Trace dumped: %u events", (unsigned)n);
+}
+
+#else
+#define TRACE(type, arg)    do { } while (0)
+#endif // TRACE_ENABLE
+
+/* ============================================================
+ * Hot-Path Profiler
+ * ============================================================ */
+
+/*
+ * Scoped cycle measurements based on the CPU cycle counter (CCOUNT).
+ * Every core owns its own slot per region, so ISRs and tasks update
+ * their statistics without locks; prof_report() sums up both cores.
+ * With PROF_ENABLE = 0 all macros compile to nothing.
+ *
+ *   PROF_SCOPE(PROF_SWAP);                 // until end of the block
+ *   PROF_RECORD(PROF_LV_DRAW, cycles);     // span measured by hand
+ */
+typedef enum {
+    PROF_FLUSH_CB,          // lvgl_flush_cb incl. present
+    PROF_FLUSH_AREA,        // Strip copy render_buf → work_buf
+    PROF_GDMA_DONE_ISR,     // gdma_copy_done_cb
+    PROF_GDMA_WAKE,         // Completion ISR → LVGL task running again
+    PROF_SWAP,              // swap_buffers
+    PROF_LV_DRAW,           // LVGL drawing one strip (between flushes)
+    PROF_LV_FRAME,          // render_start_cb → last flush done
+    PROF_REGION_COUNT
+} prof_region_t;
+
+#if PROF_ENABLE
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PROF_HIST_BUCKETS];
+} prof_slot_t;
+
+static prof_slot_t s_prof[portNUM_PROCESSORS][PROF_REGION_COUNT];
+
+static IRAM_ATTR void prof_record(prof_region_t region, uint32_t cycles)
+{
+    prof_slot_t *s = &s_prof[xPortGetCoreID()][region];
+    if (s->count == 0 || cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->sum += cycles;
+    s->count++;
+    uint32_t b = (cycles == 0) ? 0 : 32 - __builtin_clz(cycles);
+    s->hist[(b < PROF_HIST_BUCKETS) ? b : PROF_HIST_BUCKETS - 1]++;
+}
+
+typedef struct {
+    prof_region_t region;
+    esp_cpu_cycle_count_t start;
+} prof_scope_t;
+
+static inline void prof_scope_end(prof_scope_t *scope)
+{
+    prof_record(scope->region, esp_cpu_get_cycle_count() - scope->start);
+}
+
+#define PROF_NOW()                  esp_cpu_get_cycle_count()
+#define PROF_RECORD(region, cycles) prof_record((region), (cycles))
+#define PROF_SCOPE(region)                                              \
+    prof_scope_t __attribute__((cleanup(prof_scope_end)))               \
+        prof_scope_##region = { (region), esp_cpu_get_cycle_count() }
+
+/**
+ * Log min / mean / max and the log2 histogram of every region
+ */
+static void prof_report(void)
+{
+    static const char *const names[PROF_REGION_COUNT] = {
+        "flush_cb", "flush_area", "gdma_isr", "gdma_wake",
+        "swap", "lv_draw", "lv_frame",
+    };
+    const float mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
+    for (int r = 0; r < PROF_REGION_COUNT; r++) {
+        prof_slot_t sum = { 0 };
+        for (int c = 0; c < portNUM_PROCESSORS; c++) {
+            const prof_slot_t *s = &s_prof[c][r];
+            if (!s->count) continue;
+            if (!sum.count || s->min < sum.min) sum.min = s->min;
+            if (s->max > sum.max) sum.max = s->max;
+            sum.sum += s->sum;
+            sum.count += s->count;
+            for (int b = 0; b < PROF_HIST_BUCKETS; b++) sum.hist[b] += s->hist[b];
+        }
+        if (!sum.count) continue;
+
+        // Histogram as "bucket:count" for non-empty buckets, bucket b = [2^(b-1), 2^b)
+        char hist[PROF_HIST_BUCKETS * 12] = "";
+        size_t len = 0;
+        for (int b = 0; b < PROF_HIST_BUCKETS && len < sizeof(hist); b++) {
+            if (sum.hist[b]) {
+                len += snprintf(hist + len, sizeof(hist) - len, " %d:%u", b, (unsigned)sum.hist[b]);
+            }
+        }
+        uint32_t mean = (uint32_t)(sum.sum / sum.count);
+        ESP_LOGI(TAG, "PROF %-10s n=%-7u min=%u mean=%u max=%u cyc (%.1f/%.1f/%.1f us) hist:%s",
+                 names[r], (unsigned)sum.count, (unsigned)sum.min, (unsigned)mean, (unsigned)sum.max,
+                 sum.min / mhz, mean / mhz, sum.max / mhz, hist);
+    }
+}
+
+#else
+#define PROF_NOW()                  0
+#define PROF_RECORD(region, cycles) do { } while (0)
+#define PROF_SCOPE(region)          do { } while (0)
+#endif // PROF_ENABLE
+
+/* ============================================================
+ * Flash-Safe Display
+ * ============================================================ */
+
+/*
+ * While flash is written (NVS, OTA) the MSPI cache is off and PSRAM is not
+ * reachable. With FLASH_SAFE_ENABLE the panel scans out through two small
+ * bounce buffers in internal RAM, refilled by an IRAM callback
+ * (lcd_bounce_fill_cb); during a cache-off window the refill leaves the
+ * buffer as it is, so the band scanned last is repeated instead of
+ * underrunning. Code that writes flash brackets it with
+ * tb_flash_op_begin/end: the bracket waits for a running GDMA copy and
+ * holds off new ones, the LVGL task then blocks before its copy instead
+ * of stalling in the middle of it.
+ */
+#if FLASH_SAFE_ENABLE
+
+static SemaphoreHandle_t s_flash_gate = NULL;   // Held by flash ops and each GDMA copy
+static uint32_t          s_flash_depth = 0;
+static int64_t           s_flash_op_start = 0;
+
+static struct {
+    volatile uint32_t refills;          // Bounce buffer refills (ISR)
+    volatile uint32_t held_refills;     // ... skipped while the cache was off
+    uint32_t          flash_ops;
+    uint64_t          flash_op_us;      // Time inside tb_flash_op_begin/end
+    uint64_t          gate_wait_us;     // GDMA copies held back by flash ops
+} s_flash_safe;
+
+static void flash_gate_enter(void)
+{
+    int64_t t0 = esp_timer_get_time();
+    xSemaphoreTakeRecursive(s_flash_gate, portMAX_DELAY);
+    s_flash_safe.gate_wait_us += esp_timer_get_time() - t0;
+}
+
+static void flash_gate_leave(void)
+{
+    xSemaphoreGiveRecursive(s_flash_gate);
+}
+
+void tb_flash_op_begin(void)
+{
+    if (!s_flash_gate) return;
+    xSemaphoreTakeRecursive(s_flash_gate, portMAX_DELAY);
+    if (s_flash_depth++ == 0) {
+        s_flash_op_start = esp_timer_get_time();
+        s_flash_safe.flash_ops++;
+    }
+}
+
+void tb_flash_op_end(void)
+{
+    if (!s_flash_gate) return;
+    if (--s_flash_depth == 0) s_flash_safe.flash_op_us += esp_timer_get_time() - s_flash_op_start;
+    xSemaphoreGiveRecursive(s_flash_gate);
+}
+
+static void flash_safe_log(void)
+{
+    ESP_LOGI(TAG, "Flash-safe: %u refills, %u held, %u flash ops (%u ms), copies held back %u ms",
+             (unsigned)s_flash_safe.refills, (unsigned)s_flash_safe.held_refills,
+             (unsigned)s_flash_safe.flash_ops, (unsigned)(s_flash_safe.flash_op_us / 1000),
+             (unsigned)(s_flash_safe.gate_wait_us / 1000));
+}
+
+#else
+
+void tb_flash_op_begin(void)
+{
+}
+
+void tb_flash_op_end(void)
+{
+}
+
+#endif // FLASH_SAFE_ENABLE
+
+#if SNAPSHOT_ENABLE || FLUSH_RECORD_ENABLE
+/**
+ * Erase len bytes (rounded up to sectors) from off, one sector per
+ * tb_flash_op bracket so GDMA copies run in between
+ */
+static esp_err_t flash_erase_sectors(const esp_partition_t *part, size_t off, size_t len)
+{
+    esp_err_t ret = ESP_OK;
+    for (const size_t end = off + len; ret == ESP_OK && off < end; off += part->erase_size) {
+        tb_flash_op_begin();
+        ret = esp_partition_erase_range(part, off, part->erase_size);
+        tb_flash_op_end();
+    }
+    return ret;
+}
+
+/**
+ * Write len bytes to off, one sector per tb_flash_op bracket
+ */
+static esp_err_t flash_write_sectors(const esp_partition_t *part, size_t off,
+                                     const void *data, size_t len)
+{
+    esp_err_t ret = ESP_OK;
+    for (size_t done = 0; ret == ESP_OK && done < len; done += part->erase_size) {
+        const size_t n = (len - done < part->erase_size) ? len - done : part->erase_size;
+        tb_flash_op_begin();
+        ret = esp_partition_write(part, off + done, (const uint8_t *)data + done, n);
+        tb_flash_op_end();
+    }
+    return ret;
+}
+#endif
+
+/* ============================================================
+ * Hybrid Framebuffer
+ * ============================================================ */
+
+/*
+ * With HYBRID_FB_ENABLE the rows HYBRID_BAND_Y.. of each buffer live in
+ * internal RAM; the PSRAM rows behind them are unused. Everything that
+ * touches pixels by row goes through fb_row(): the flush, the overlays
+ * and the bounce refill of the scanout; the frame copy moves the band by
+ * CPU and the rest by GDMA (fb_copy_frame). Captures see a contiguous
+ * buffer: tb_front_pin() and the swap callback first write the band back
+ * to its PSRAM rows.
+ */
+#define ROW_BYTES       (DISP_WIDTH * DISP_BPP)
+
+#if HYBRID_FB_ENABLE
+#define BAND_Y0         HYBRID_BAND_Y
+#define BAND_Y1         (HYBRID_BAND_Y + HYBRID_BAND_LINES)
+#define BAND_BYTES      (HYBRID_BAND_LINES * ROW_BYTES)
+
+static uint8_t *s_band_fb[3];                   // PSRAM buffers ...
+static uint8_t *s_band[3];                      // ... and their bands
+static volatile uint32_t s_band_scan_bytes;     // Scanout reads served by the band
+
+static inline __attribute__((always_inline)) uint8_t *fb_band(const uint8_t *buf)
+{
+    return (buf == s_band_fb[0]) ? s_band[0] : (buf == s_band_fb[1]) ? s_band[1] : s_band[2];
+}
+
+/**
+ * Write the band back into its PSRAM rows (for readers of the whole buffer)
+ */
+static void fb_band_store(uint8_t *buf)
+{
+    memcpy(buf + BAND_Y0 * ROW_BYTES, fb_band(buf), BAND_BYTES);
+}
+#endif
+
+/**
+ * Row y of a framebuffer (IRAM-safe, also used by the bounce refill)
+ */
+static inline __attribute__((always_inline)) uint8_t *fb_row(const uint8_t *buf, int y)
+{
+#if HYBRID_FB_ENABLE
+    if (y >= BAND_Y0 && y < BAND_Y1) return fb_band(buf) + (y - BAND_Y0) * ROW_BYTES;
+#endif
+    return (uint8_t *)buf + y * ROW_BYTES;
+}
+
 /* ============================================================
- * GDMA Async Memcpy
+ * GDMA Memcpy
  * ============================================================ */
 
+#if PROF_ENABLE
+// Time of the semaphore give, to measure ISR → task wake latency. The ISR
+// runs on core 0 and the LVGL task on core 1, whose CCOUNTs are not
+// synchronized, so this one uses esp_timer (1 µs resolution).
+static volatile int64_t s_copy_done_us;
+#endif
+
+/*
+ * The copy engine is a memory-to-memory GDMA channel pair owned by this
+ * file, so a stalled copy can be stopped: one descriptor chain per copy,
+ * the RX EOF interrupt signals completion. The wait is bounded by a
+ * deadline from the size and the measured GDMA rate during scanout
+ * (estimated from the plan before calibration). When it passes, both
+ * channels are stopped and reset; the RX descriptors the DMA handed back
+ * (owner = CPU) tell how far the copy got, and the CPU copies only the
+ * rest. If the channels cannot be stopped, nothing they report is
+ * trusted: the CPU copies everything, now and from then on.
+ */
+#define GDMA_DESC_COUNT     ((FB_SIZE + GDMA_DESC_BYTES - 1) / GDMA_DESC_BYTES)
+
+static DRAM_ATTR dma_descriptor_t s_gdma_tx_desc[GDMA_DESC_COUNT];
+static DRAM_ATTR dma_descriptor_t s_gdma_rx_desc[GDMA_DESC_COUNT];
+
 /**
- * ISR Callback - called when GDMA copy is complete
+ * ISR Callback - called when GDMA copy is complete (RX EOF)
  */
-static IRAM_ATTR bool gdma_copy_done_cb(async_memcpy_handle_t hdl,
-                                         async_memcpy_event_t *event,
-                                         void *cb_args)
+static IRAM_ATTR bool gdma_copy_done_cb(gdma_channel_handle_t chan,
+                                         gdma_event_data_t *event,
+                                         void *user_data)
 {
+    PROF_SCOPE(PROF_GDMA_DONE_ISR);
+    if (!s_copy_armed) return false;    // Copy was stopped by the watchdog
+    s_copy_armed = false;
     BaseType_t high_task_wakeup = pdFALSE;
+    TRACE(TRACE_GDMA_END, 0);
+#if PROF_ENABLE
+    s_copy_done_us = esp_timer_get_time();
+#endif
     xSemaphoreGiveFromISR(s_copy_done_sem, &high_task_wakeup);
     return (high_task_wakeup == pdTRUE);
 }
@@ -85,10 +736,138 @@ static esp_err_t gdma_copy_init(void)
     s_copy_done_sem = xSemaphoreCreateBinary();
     if (!s_copy_done_sem) return ESP_ERR_NO_MEM;
 
-    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
-    config.backlog = 4;
     // AHB GDMA for PSRAM access on ESP32-S3
-    return esp_async_memcpy_install_gdma_ahb(&config, &s_mcp_handle);
+    gdma_channel_alloc_config_t tx_config = { .direction = GDMA_CHANNEL_DIRECTION_TX };
+    ESP_RETURN_ON_ERROR(gdma_new_ahb_channel(&tx_config, &s_gdma_tx), TAG, "GDMA TX channel failed");
+    gdma_channel_alloc_config_t rx_config = {
+        .direction = GDMA_CHANNEL_DIRECTION_RX,
+        .sibling_chan = s_gdma_tx,
+    };
+    ESP_RETURN_ON_ERROR(gdma_new_ahb_channel(&rx_config, &s_gdma_rx), TAG, "GDMA RX channel failed");
+
+    uint32_t free_ids = 0;
+    ESP_RETURN_ON_ERROR(gdma_get_free_m2m_trig_id_mask(s_gdma_tx, &free_ids), TAG, "M2M trigger failed");
+    ESP_RETURN_ON_FALSE(free_ids, ESP_ERR_NOT_FOUND, TAG, "No free M2M trigger");
+    const gdma_trigger_t trig = GDMA_MAKE_TRIGGER(GDMA_TRIG_PERIPH_M2M, __builtin_ctz(free_ids));
+
+    // The DMA hands finished descriptors back (owner = CPU): the progress
+    // of a stopped copy
+    const gdma_strategy_config_t strategy = { .owner_check = true, .auto_update_desc = true };
+    const gdma_transfer_ability_t ability = { .sram_trans_align = 4, .psram_trans_align = 16 };
+    gdma_channel_handle_t chans[] = { s_gdma_tx, s_gdma_rx };
+    for (int i = 0; i < 2; i++) {
+        ESP_RETURN_ON_ERROR(gdma_connect(chans[i], trig), TAG, "GDMA connect failed");
+        ESP_RETURN_ON_ERROR(gdma_apply_strategy(chans[i], &strategy), TAG, "GDMA strategy failed");
+        ESP_RETURN_ON_ERROR(gdma_set_transfer_ability(chans[i], &ability), TAG, "GDMA alignment failed");
+    }
+    gdma_rx_event_callbacks_t cbs = { .on_recv_eof = gdma_copy_done_cb };
+    ESP_RETURN_ON_ERROR(gdma_register_rx_event_callbacks(s_gdma_rx, &cbs, NULL),
+                        TAG, "GDMA callback registration failed");
+    s_gdma_ok = true;
+    return ESP_OK;
+}
+
+/**
+ * CPU copy, written back so LCD_CAM and GDMA see it in PSRAM
+ */
+static void cpu_copy(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+    esp_cache_msync(dst, len, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+}
+
+/**
+ * Longest a GDMA copy of len bytes may take before it counts as stalled
+ */
+static uint32_t gdma_deadline_us(size_t len)
+{
+    uint32_t bw = s_calib.gdma_scan_bw ? s_calib.gdma_scan_bw : s_plan.psram_bw / 4;
+    if (bw < GDMA_WDT_MIN_BW) bw = GDMA_WDT_MIN_BW;
+    return GDMA_WDT_SLACK_US + (uint32_t)((uint64_t)len * GDMA_WDT_FACTOR * 1000000 / bw);
+}
+
+/**
+ * Chain the descriptors for one copy, returns their number
+ */
+static uint32_t gdma_link(uint8_t *dst, const uint8_t *src, size_t len)
+{
+    const uint32_t n = (len + GDMA_DESC_BYTES - 1) / GDMA_DESC_BYTES;
+    for (uint32_t i = 0; i < n; i++) {
+        const size_t off = i * GDMA_DESC_BYTES;
+        const uint32_t sz = (len - off < GDMA_DESC_BYTES) ? len - off : GDMA_DESC_BYTES;
+        const bool last = (i == n - 1);
+        dma_descriptor_t *tx = &s_gdma_tx_desc[i], *rx = &s_gdma_rx_desc[i];
+        tx->dw0.size = sz;
+        tx->dw0.length = sz;
+        tx->dw0.suc_eof = last;
+        tx->dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+        tx->buffer = (void *)(src + off);
+        tx->next = last ? NULL : tx + 1;
+        rx->dw0.size = sz;
+        rx->dw0.length = 0;
+        rx->dw0.suc_eof = 0;
+        rx->dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+        rx->buffer = dst + off;
+        rx->next = last ? NULL : rx + 1;
+    }
+    return n;
+}
+
+/**
+ * Cache side of a GDMA copy: GDMA reads and writes PSRAM past the cache.
+ * Before: write back src, and the partial lines at both ends of dst so the
+ * invalidate afterwards, rounded out to FB_ALIGN, drops no CPU data.
+ */
+static void gdma_cache_before(void *dst, const void *src, size_t len)
+{
+    const int wb = ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED;
+    esp_cache_msync((void *)src, len, wb);
+    esp_cache_msync(dst, 1, wb);
+    esp_cache_msync((uint8_t *)dst + len - 1, 1, wb);
+}
+
+static void gdma_cache_after(void *dst, size_t len)
+{
+    const uintptr_t a = (uintptr_t)dst & ~(uintptr_t)(FB_ALIGN - 1);
+    const uintptr_t b = ((uintptr_t)dst + len + FB_ALIGN - 1) & ~(uintptr_t)(FB_ALIGN - 1);
+    esp_cache_msync((void *)a, b - a, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+}
+
+static inline bool gdma_desc_done(const dma_descriptor_t *d)
+{
+    return ((const volatile dma_descriptor_t *)d)->dw0.owner == DMA_DESCRIPTOR_BUFFER_OWNER_CPU;
+}
+
+/**
+ * Stalled copy: stop and reset both channels, then copy by CPU what the
+ * DMA has not handed back of the n descriptors
+ */
+static void gdma_recover(uint8_t *dst, const uint8_t *src, size_t len, uint32_t n)
+{
+    s_gdma.stalls++;
+    s_copy_armed = false;
+    esp_err_t ret = gdma_stop(s_gdma_tx);
+    if (ret == ESP_OK) ret = gdma_stop(s_gdma_rx);
+    if (ret == ESP_OK) ret = gdma_reset(s_gdma_tx);
+    if (ret == ESP_OK) ret = gdma_reset(s_gdma_rx);
+
+    // Only stopped channels have a final progress
+    size_t done = 0;
+    if (ret == ESP_OK) {
+        for (uint32_t i = 0; i < n && gdma_desc_done(&s_gdma_rx_desc[i]); i++) {
+            done += s_gdma_rx_desc[i].dw0.size;
+        }
+        s_gdma.recoveries++;
+    } else {
+        s_gdma_ok = false;
+        ESP_LOGE(TAG, "GDMA stop failed (0x%x), copying by CPU from now on", ret);
+    }
+    xSemaphoreTake(s_copy_done_sem, 0);     // Completion that raced the stop
+
+    cpu_copy(dst + done, src + done, len - done);
+    s_gdma.cpu_bytes += len - done;
+    ESP_LOGW(TAG, "GDMA stalled at %u of %u bytes, rest copied by CPU",
+             (unsigned)done, (unsigned)len);
 }
 
 /**
@@ -96,213 +875,4370 @@ static esp_err_t gdma_copy_init(void)
  */
 static void gdma_copy_buffer(void *dst, const void *src, size_t len)
 {
+    // Small copies: the CPU is done before GDMA setup and the completion
+    // interrupt would be (crossover measured by calib_measure_copy)
+    if (len < s_calib.copy_crossover || !s_gdma_ok || len > GDMA_DESC_COUNT * GDMA_DESC_BYTES) {
+        cpu_copy(dst, src, len);
+        s_stats.copy_bytes += len;      // Same PSRAM traffic as the GDMA copy
+        if (!s_gdma_ok) s_gdma.cpu_bytes += len;
+        return;
+    }
+#if FLASH_SAFE_ENABLE
+    flash_gate_enter();
+#endif
     s_copy_in_progress = true;
-    
-    esp_err_t ret = esp_async_memcpy(s_mcp_handle, dst, (void *)src, len,
-                                      gdma_copy_done_cb, NULL);
+
+    TRACE(TRACE_GDMA_START, len / 1024);
+    gdma_cache_before(dst, src, len);
+    const uint32_t n = gdma_link(dst, src, len);
+    xSemaphoreTake(s_copy_done_sem, 0);
+    s_copy_armed = true;
+    esp_err_t ret = gdma_start(s_gdma_rx, (intptr_t)s_gdma_rx_desc);
+    if (ret == ESP_OK) ret = gdma_start(s_gdma_tx, (intptr_t)s_gdma_tx_desc);
     if (ret != ESP_OK) {
-        // Fallback: CPU memcpy
+        // Fallback: CPU memcpy (an RX channel already started waits for data)
         ESP_LOGW(TAG, "GDMA copy failed (0x%x), falling back to memcpy", ret);
-        memcpy(dst, src, len);
-        s_copy_in_progress = false;
-        return;
+        s_copy_armed = false;
+        gdma_stop(s_gdma_rx);
+        gdma_reset(s_gdma_rx);
+        cpu_copy(dst, src, len);
+        s_gdma.cpu_bytes += len;
     }
-    
+
     // Wait until DMA is done (blocks this task, but CPU is free for other tasks)
-    xSemaphoreTake(s_copy_done_sem, portMAX_DELAY);
+    const int64_t t0 = esp_timer_get_time();
+    const int64_t deadline = t0 + gdma_deadline_us(len);
+    while (ret == ESP_OK && !gdma_desc_done(&s_gdma_rx_desc[n - 1])) {
+        const int64_t left = deadline - esp_timer_get_time();
+        if (left <= 0) {
+            gdma_recover(dst, src, len, n);
+            break;
+        }
+        xSemaphoreTake(s_copy_done_sem, pdMS_TO_TICKS((uint32_t)(left / 1000)) + 1);
+    }
+    s_copy_armed = false;
+    // CPU readers (bounce refill, stream, screenshot, patches) see the copy
+    gdma_cache_after(dst, len);
+#if PROF_ENABLE
+    PROF_RECORD(PROF_GDMA_WAKE, (esp_timer_get_time() - s_copy_done_us) * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+#endif
+    s_stats.copy_wait_us += esp_timer_get_time() - t0;
+    s_stats.copy_bytes += len;
     s_copy_in_progress = false;
+#if FLASH_SAFE_ENABLE
+    flash_gate_leave();
+#endif
+}
+
+void tb_gdma_get_stats(tb_gdma_stats_t *out)
+{
+    *out = s_gdma;
+}
+
+static void gdma_log(void)
+{
+    if (!s_gdma.stalls && !s_gdma.cpu_bytes) return;
+    ESP_LOGW(TAG, "GDMA: %u stalls, %u recovered, %u KB copied by CPU instead",
+             (unsigned)s_gdma.stalls, (unsigned)s_gdma.recoveries,
+             (unsigned)(s_gdma.cpu_bytes / 1024));
+}
+
+/**
+ * Copy a whole frame, the hybrid band by CPU within internal RAM
+ */
+static void fb_copy_frame(uint8_t *dst, const uint8_t *src)
+{
+#if HYBRID_FB_ENABLE
+    if (BAND_Y0 > 0) gdma_copy_buffer(dst, src, BAND_Y0 * ROW_BYTES);
+    memcpy(fb_band(dst), fb_band(src), BAND_BYTES);
+    if (BAND_Y1 < DISP_HEIGHT) {
+        gdma_copy_buffer(dst + BAND_Y1 * ROW_BYTES, src + BAND_Y1 * ROW_BYTES,
+                         (DISP_HEIGHT - BAND_Y1) * ROW_BYTES);
+    }
+    s_stats.band_bytes += 2 * BAND_BYTES;   // Read + write
+#else
+    gdma_copy_buffer(dst, src, FB_SIZE);
+#endif
 }
 
 /* ============================================================
  * Buffer Swap
  * ============================================================ */
 
+// Published swap event: generation counter + optional callback
+static volatile uint32_t s_front_gen = 0;
+static tb_swap_cb_t      s_swap_cb = NULL;
+static void             *s_swap_cb_ctx = NULL;
+static SemaphoreHandle_t s_front_pin = NULL;    // Held while a capture reads front_buf
+
 /**
  * Swap back and front buffer.
  * After this, LCD_CAM displays the new front buffer.
  */
 static void swap_buffers(void)
 {
+    PROF_SCOPE(PROF_SWAP);
+    // A capture is reading the Front Buffer → wait until it is released
+    if (s_front_pin) xSemaphoreTake(s_front_pin, portMAX_DELAY);
+
     uint8_t *tmp = front_buf;
     front_buf = back_buf;
     back_buf = tmp;
+    TRACE(TRACE_SWAP, 0);
 
+#if !SCANOUT_BOUNCE
     // Tell LCD_CAM panel about the new framebuffer
     // For esp_lcd_rgb_panel: the next VSYNC picks up the new buffer
     esp_lcd_panel_draw_bitmap(s_panel_handle, 0, 0, DISP_WIDTH, DISP_HEIGHT, front_buf);
+#endif
+
+    s_front_gen++;
+#if HYBRID_FB_ENABLE
+    if (s_swap_cb) fb_band_store(front_buf);
+#endif
+    if (s_front_pin) xSemaphoreGive(s_front_pin);
+    if (s_swap_cb) s_swap_cb(s_front_gen, (const uint16_t *)front_buf, s_swap_cb_ctx);
+}
+
+uint32_t tb_front_generation(void)
+{
+    return s_front_gen;
+}
+
+const uint16_t *tb_front_buffer(uint32_t *generation)
+{
+    // Read generation first: if it still matches after the caller is done
+    // reading, the pixels belonged to that frame
+    if (generation) *generation = s_front_gen;
+    return (const uint16_t *)front_buf;
+}
+
+void tb_set_swap_callback(tb_swap_cb_t cb, void *ctx)
+{
+    s_swap_cb_ctx = ctx;
+    s_swap_cb = cb;
 }
 
 /* ============================================================
- * LVGL Flush Callback
+ * Damage Tracking / Visualization
  * ============================================================ */
 
 /**
- * LVGL calls this callback for each rendered region.
- * 
- * Since we use a full-frame Work Buffer, LVGL copies its
- * internal render results directly into the Work Buffer.
- * 
- * When the last flush of a frame arrives:
- *   1. GDMA: Copy Work → Back
- *   2. Pointer swap: Back ↔ Front
+ * Add a flushed area to the current frame's damage list. When the list is
+ * full, the last entry grows to the bounding box, so it stays conservative.
  */
-static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, 
-                           lv_color_t *color_map)
+static void damage_add(const lv_area_t *area)
 {
-    // LVGL hat einen Streifen im schnellen internen RAM gerendert.
-    // Jetzt kopieren wir nur diesen Streifen in den PSRAM Work Buffer.
-    
-    uint32_t w = area->x2 - area->x1 + 1;
-    uint32_t h = area->y2 - area->y1 + 1;
-    
-    // Zeilenweise in den Work Buffer (PSRAM) kopieren
-    for (int y = 0; y < h; y++) {
-        uint16_t *src = (uint16_t *)color_map + y * w;
-        uint16_t *dst = (uint16_t *)work_buf + 
-                        ((area->y1 + y) * DISP_WIDTH + area->x1);
-        memcpy(dst, src, w * sizeof(uint16_t));
+    s_damage.pixels += lv_area_get_size(area);
+    if (s_damage.count < DAMAGE_MAX_AREAS) {
+        s_damage.areas[s_damage.count++] = *area;
+        return;
     }
+    lv_area_t *a = &s_damage.areas[DAMAGE_MAX_AREAS - 1];
+    if (area->x1 < a->x1) a->x1 = area->x1;
+    if (area->y1 < a->y1) a->y1 = area->y1;
+    if (area->x2 > a->x2) a->x2 = area->x2;
+    if (area->y2 > a->y2) a->y2 = area->y2;
+}
 
-    if (lv_disp_flush_is_last(drv)) {
-        // Frame komplett → GDMA copy work → back, dann swap
-        gdma_copy_buffer(back_buf, work_buf, FB_SIZE);
-        swap_buffers();
-    }
+#if DAMAGE_VIS_ENABLE
 
-    lv_disp_flush_ready(drv);
-}
-```
+/*
+ * Every flushed area is tinted in the outgoing Back Buffer (like the HUD,
+ * after the GDMA copy, so LVGL's Work Buffer stays clean): red for the
+ * current frame, fading over DAMAGE_VIS_FRAMES frames. The copy
+ * work → back always covers the full frame, so it isn't tinted.
+ *
+ * Independently, every 16x16 tile counts the frames in which it was
+ * damaged; tb_damage_dump_heatmap() prints the counts.
+ */
+#define DAMAGE_TILES_X  ((DISP_WIDTH + DAMAGE_TILE - 1) / DAMAGE_TILE)
+#define DAMAGE_TILES_Y  ((DISP_HEIGHT + DAMAGE_TILE - 1) / DAMAGE_TILE)
 
-## Der Unterschied
-```
-Direct Mode (vorher):
-  LVGL → random writes in PSRAM (langsam!) → GDMA → swap
+static frame_damage_t s_damage_hist[DAMAGE_VIS_FRAMES];     // [0] = newest
+static uint32_t       s_heatmap[DAMAGE_TILES_Y][DAMAGE_TILES_X];
+static uint32_t       s_heatmap_frames;
 
-Partial Mode (besser):
-  LVGL → random writes in internem SRAM (schnell!)
-       → sequentieller memcpy in PSRAM (cache-freundlich)
-       → GDMA → swap
+static void damage_tint(uint8_t *buf, const lv_area_t *a, lv_color_t tint, lv_opa_t opa)
+{
+    for (int y = a->y1; y <= a->y2; y++) {
+        lv_color_t *row = (lv_color_t *)fb_row(buf, y);
+        for (int x = a->x1; x <= a->x2; x++) {
+            row[x] = lv_color_mix(tint, row[x], opa);
+        }
+    }
+}
+
+/**
+ * Update heatmap and tint recent damage into buf (the Back Buffer)
+ */
+static void damage_visualize(uint8_t *buf)
+{
+    // Heatmap: count each tile at most once per frame
+    static uint8_t hit[DAMAGE_TILES_Y][DAMAGE_TILES_X];
+    memset(hit, 0, sizeof(hit));
+    for (uint32_t i = 0; i < s_damage.count; i++) {
+        const lv_area_t *a = &s_damage.areas[i];
+        for (int ty = a->y1 / DAMAGE_TILE; ty <= a->y2 / DAMAGE_TILE; ty++) {
+            for (int tx = a->x1 / DAMAGE_TILE; tx <= a->x2 / DAMAGE_TILE; tx++) {
+                hit[ty][tx] = 1;
+            }
+        }
+    }
+    for (int ty = 0; ty < DAMAGE_TILES_Y; ty++) {
+        for (int tx = 0; tx < DAMAGE_TILES_X; tx++) s_heatmap[ty][tx] += hit[ty][tx];
+    }
+    s_heatmap_frames++;
+
+    memmove(&s_damage_hist[1], &s_damage_hist[0], sizeof(s_damage_hist) - sizeof(s_damage_hist[0]));
+    s_damage_hist[0] = s_damage;
+
+    // Oldest first, so the newest tint ends up on top
+    int y_min = DISP_HEIGHT, y_max = -1;
+    const lv_color_t tint = lv_palette_main(LV_PALETTE_RED);
+    for (int age = DAMAGE_VIS_FRAMES - 1; age >= 0; age--) {
+        lv_opa_t opa = LV_OPA_50 >> age;
+        for (uint32_t i = 0; i < s_damage_hist[age].count; i++) {
+            const lv_area_t *a = &s_damage_hist[age].areas[i];
+            damage_tint(buf, a, tint, opa);
+            if (a->y1 < y_min) y_min = a->y1;
+            if (a->y2 > y_max) y_max = a->y2;
+        }
+    }
+
+    // LCD_CAM reads PSRAM directly → write the tinted rows back from the cache
+    if (y_max >= 0) {
+        esp_cache_msync(buf + y_min * DISP_WIDTH * DISP_BPP,
+                        (y_max - y_min + 1) * DISP_WIDTH * DISP_BPP,
+                        ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+    }
+}
+
+void tb_damage_dump_heatmap(void)
+{
+    // One CSV row per tile row, value = % of frames in which the tile was damaged
+    printf("HEATMAP_BEGIN %d %d %d %u\n", DAMAGE_TILE, DAMAGE_TILES_X, DAMAGE_TILES_Y,
+           (unsigned)s_heatmap_frames);
+    for (int ty = 0; ty < DAMAGE_TILES_Y; ty++) {
+        for (int tx = 0; tx < DAMAGE_TILES_X; tx++) {
+            unsigned pct = s_heatmap_frames ? 100u * s_heatmap[ty][tx] / s_heatmap_frames : 0;
+            printf((tx == DAMAGE_TILES_X - 1) ? "%u\n" : "%u,", pct);
+        }
+    }
+    printf("HEATMAP_END\n");
+}
+
+#else
+
+void tb_damage_dump_heatmap(void)
+{
+    ESP_LOGW(TAG, "Heatmap needs DAMAGE_VIS_ENABLE");
+}
+
+#endif // DAMAGE_VIS_ENABLE
 
 /* ============================================================
- * Buffer Allocation
+ * Performance HUD
  * ============================================================ */
 
-static esp_err_t allocate_buffers(void)
+#if HUD_ENABLE
+
+/*
+ * Drawn by the CPU into the Back Buffer after the GDMA copy and right
+ * before the swap, i.e. into the frame that becomes the Front Buffer.
+ * The Work Buffer is never touched, so LVGL sees no invalidations and the
+ * workload stays the same. Every frame writes exactly HUD_W * HUD_H pixels:
+ *
+ *   ┌────────────────────────────┐
+ *   │ 28.3   35.3   17.1         │  FPS (white), frame ms (yellow), copy ms (cyan)
+ *   │ ▂▃▂▂▅▂▂▂▃▂▂▂▂▇▂▂▂▂▃▂▂▂▂▂▂▂▂ │  frame times, 1 bar per frame, line = 33 ms
+ *   └────────────────────────────┘
+ */
+#define HUD_TEXT_H      12
+#define HUD_GRAPH_H     (HUD_H - HUD_TEXT_H - 2)
+#define HUD_GRAPH_MS    50      // Full graph height
+#define HUD_HISTORY     (HUD_W / 2)
+
+// 3x5 digits, one row per byte (bit 2 = left column); index 10 = '.'
+static const uint8_t s_hud_font[11][5] = {
+    {7,5,5,5,7}, {2,6,2,2,7}, {7,1,7,4,7}, {7,1,3,1,7}, {5,5,7,1,1},
+    {7,4,7,1,7}, {7,4,7,5,7}, {7,1,1,2,2}, {7,5,7,5,7}, {7,5,7,1,7},
+    {0,0,0,0,2},
+};
+
+static struct {
+    uint8_t  frame_ms[HUD_HISTORY];     // Ring of frame times, clamped
+    uint32_t head;
+    float    fps_ewma;
+    uint32_t draw_us;                   // Last measured HUD cost
+    uint64_t pixels;                    // Total HUD pixels written
+} s_hud;
+
+static inline uint16_t *hud_px(uint8_t *buf, int x, int y)
 {
-    // All 3 buffers in PSRAM, cache-aligned
-    work_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
-    front_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
-    back_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
+    return (uint16_t *)fb_row(buf, HUD_Y + y) + HUD_X + x;
+}
 
-    if (!work_buf || !front_buf || !back_buf) {
-        ESP_LOGE(TAG, "Buffer allocation failed! Need 3x %d bytes PSRAM", FB_SIZE);
-        return ESP_ERR_NO_MEM;
+// Draws "dd.d" (2x scaled) at HUD-relative position, returns end x
+static int hud_number(uint8_t *buf, int x, int y, float v, uint16_t color)
+{
+    int iv = (int)(v * 10.0f + 0.5f);
+    if (iv > 999) iv = 999;
+    if (iv < 0) iv = 0;
+    const int glyphs[4] = { iv / 100, (iv / 10) % 10, 10, iv % 10 };
+    for (int g = 0; g < 4; g++) {
+        for (int row = 0; row < 10; row++) {
+            uint8_t bits = s_hud_font[glyphs[g]][row / 2];
+            for (int col = 0; col < 6; col++) {
+                if (bits & (4 >> (col / 2))) *hud_px(buf, x + col, y + row) = color;
+            }
+        }
+        x += 8;
     }
+    return x;
+}
 
-    // Clear buffers (black screen)
-    memset(work_buf, 0, FB_SIZE);
-    memset(front_buf, 0, FB_SIZE);
-    memset(back_buf, 0, FB_SIZE);
+/**
+ * Draw the HUD into buf (the Back Buffer about to be shown)
+ */
+static void hud_draw(uint8_t *buf, uint32_t frame_us, uint32_t copy_us)
+{
+    int64_t t0 = esp_timer_get_time();
 
-    ESP_LOGI(TAG, "3 framebuffers allocated: %d bytes each (%.1f MB total)", 
-             FB_SIZE, (3.0f * FB_SIZE) / (1024.0f * 1024.0f));
-    
+    float ms = frame_us / 1000.0f;
+    s_hud.frame_ms[s_hud.head++ % HUD_HISTORY] = (ms > 255) ? 255 : (uint8_t)ms;
+    if (frame_us) {
+        float fps = 1e6f / frame_us;
+        s_hud.fps_ewma = s_hud.fps_ewma ? 0.9f * s_hud.fps_ewma + 0.1f * fps : fps;
+    }
+
+    const uint16_t bg     = lv_color_make(16, 16, 16).full;
+    const uint16_t white  = lv_color_white().full;
+    const uint16_t yellow = lv_color_make(255, 220, 0).full;
+    const uint16_t cyan   = lv_color_make(0, 220, 255).full;
+    const uint16_t green  = lv_color_make(0, 200, 0).full;
+    const uint16_t red    = lv_color_make(255, 40, 40).full;
+    const uint16_t grid   = lv_color_make(90, 90, 90).full;
+
+    // Background (this is the bounded part: all HUD_W * HUD_H pixels)
+    for (int y = 0; y < HUD_H; y++) {
+        uint16_t *row = hud_px(buf, 0, y);
+        for (int x = 0; x < HUD_W; x++) row[x] = bg;
+    }
+
+    int x = hud_number(buf, 2, 1, s_hud.fps_ewma, white);
+    x = hud_number(buf, x + 8, 1, ms, yellow);
+    hud_number(buf, x + 8, 1, copy_us / 1000.0f, cyan);
+
+    // Frame-time graph, oldest left, 2 px per frame
+    const int base = HUD_H - 1;
+    const int line = base - 33 * HUD_GRAPH_H / HUD_GRAPH_MS;
+    for (int i = 0; i < HUD_HISTORY; i++) {
+        uint8_t v = s_hud.frame_ms[(s_hud.head + i) % HUD_HISTORY];
+        int h = v * HUD_GRAPH_H / HUD_GRAPH_MS;
+        if (h > HUD_GRAPH_H) h = HUD_GRAPH_H;
+        uint16_t c = (v > 33) ? red : green;
+        for (int y = base - h + 1; y <= base; y++) {
+            *hud_px(buf, 2 * i, y) = c;
+            *hud_px(buf, 2 * i + 1, y) = c;
+        }
+    }
+    for (int x2 = 0; x2 < HUD_W; x2 += 2) *hud_px(buf, x2, line) = grid;
+
+    // LCD_CAM reads PSRAM directly → write the HUD rows back from the cache
+    esp_cache_msync(buf + (HUD_Y * DISP_WIDTH + HUD_X) * DISP_BPP, ((HUD_H - 1) * DISP_WIDTH + HUD_W) * DISP_BPP,
+                    ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+
+    s_hud.pixels += HUD_W * HUD_H;
+    s_hud.draw_us = (uint32_t)(esp_timer_get_time() - t0);
+}
+
+#endif // HUD_ENABLE
+
+/* ============================================================
+ * Front Buffer Capture / Remote View
+ * ============================================================ */
+
+/*
+ * RLE codec for RGB565 (also used for the suspend snapshot). The stream
+ * is a sequence of 16-bit little-endian tokens:
+ *
+ *   1nnnnnnn nnnnnnnn  p        → pixel p repeated n+1 times
+ *   0nnnnnnn nnnnnnnn  p0..pn   → n+1 literal pixels
+ *
+ * Worst case (no runs) adds 2 bytes per 32768 pixels.
+ */
+#define RLE_MAX_RUN     32768
+#define RLE_BOUND(px)   ((px) * 2 + ((px) / RLE_MAX_RUN + 1) * 2)
+
+/**
+ * Encode w x h pixels with the given row stride (in pixels), returns bytes
+ */
+static size_t rle_encode(const uint16_t *src, int w, int h, int stride, uint8_t *out)
+{
+    uint16_t *o = (uint16_t *)out;
+    uint16_t *lit_hdr = NULL;   // Open literal token, if any
+    uint32_t run = 0;
+    uint16_t cur = 0;
+
+    // Flatten rows: the stream does not care about row boundaries
+    for (int y = 0; y < h; y++) {
+        const uint16_t *row = src + y * stride;
+        for (int x = 0; x < w; x++) {
+            uint16_t p = row[x];
+            if (run && p == cur && run < RLE_MAX_RUN) {
+                run++;
+                continue;
+            }
+            // Flush the pending run: runs of 1-2 go into literals
+            if (run >= 3) {
+                *o++ = 0x8000 | (run - 1);
+                *o++ = cur;
+                lit_hdr = NULL;
+            } else {
+                for (uint32_t i = 0; i < run; i++) {
+                    if (!lit_hdr || (*lit_hdr & 0x7FFF) == RLE_MAX_RUN - 1) {
+                        lit_hdr = o++;
+                        *lit_hdr = 0xFFFF;  // Becomes 0 on the first increment
+                    }
+                    (*lit_hdr)++;
+                    *o++ = cur;
+                }
+            }
+            cur = p;
+            run = 1;
+        }
+    }
+    // Final run
+    if (run >= 3) {
+        *o++ = 0x8000 | (run - 1);
+        *o++ = cur;
+    } else {
+        for (uint32_t i = 0; i < run; i++) {
+            if (!lit_hdr || (*lit_hdr & 0x7FFF) == RLE_MAX_RUN - 1) {
+                lit_hdr = o++;
+                *lit_hdr = 0xFFFF;
+            }
+            (*lit_hdr)++;
+            *o++ = cur;
+        }
+    }
+    return (uint8_t *)o - out;
+}
+
+#if SNAPSHOT_ENABLE || IMG_DECODER_ENABLE
+/**
+ * Decode into w x h pixels with the given row stride, returns false on
+ * malformed or truncated input
+ */
+static bool rle_decode(const uint8_t *in, size_t len, uint16_t *dst, int w, int h, int stride)
+{
+    const uint16_t *i = (const uint16_t *)in;
+    const uint16_t *end = i + len / 2;
+    int x = 0, y = 0;
+    uint16_t *row = dst;
+
+    while (y < h) {
+        if (i >= end) return false;
+        uint16_t tok = *i++;
+        uint32_t n = (tok & 0x7FFF) + 1;
+        bool is_run = tok & 0x8000;
+        if (is_run ? (i >= end) : (i + n > end)) return false;
+        uint16_t p = is_run ? *i++ : 0;
+
+        while (n) {
+            uint32_t chunk = (uint32_t)(w - x) < n ? (uint32_t)(w - x) : n;
+            if (is_run) {
+                for (uint32_t k = 0; k < chunk; k++) row[x + k] = p;
+            } else {
+                memcpy(&row[x], i, chunk * 2);
+                i += chunk;
+            }
+            x += chunk;
+            n -= chunk;
+            if (x == w) {
+                x = 0;
+                row += stride;
+                if (++y == h) return n == 0;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+void tb_front_pin(void)
+{
+    if (s_front_pin) xSemaphoreTake(s_front_pin, portMAX_DELAY);
+#if HYBRID_FB_ENABLE
+    fb_band_store(front_buf);
+#endif
+}
+
+void tb_front_unpin(void)
+{
+    if (s_front_pin) xSemaphoreGive(s_front_pin);
+}
+
+#define STREAM_BAND_ROWS 16     // Rows encoded per pin: a swap waits for one band at most
+
+/**
+ * Pin the Front Buffer for rows y0..y1 (the hybrid band is only written
+ * back when they touch it)
+ */
+static void stream_pin_rows(int y0, int y1)
+{
+    if (s_front_pin) xSemaphoreTake(s_front_pin, portMAX_DELAY);
+#if HYBRID_FB_ENABLE
+    if (y0 < BAND_Y1 && y1 >= BAND_Y0) fb_band_store(front_buf);
+#endif
+}
+
+/*
+ * Packet layout (little endian), written to the sink in one call each:
+ *
+ *   "TBV1" | u8 type ('K' keyframe / 'D' delta) | u8 pad | u16 n_rects | u32 generation
+ *   n_rects x { u16 x, y, w, h | u32 len | len bytes RLE }
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];
+    uint8_t  type;
+    uint8_t  pad;
+    uint16_t n_rects;
+    uint32_t generation;
+} stream_pkt_hdr_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t x, y, w, h;
+    uint32_t len;
+} stream_rect_hdr_t;
+
+#if STREAM_ENABLE
+
+static struct {
+    tb_stream_sink_t sink;
+    TaskHandle_t     task;
+    uint8_t         *out;           // Encode buffer (PSRAM)
+    portMUX_TYPE     lock;
+    frame_damage_t   pending;       // Damage since the last sent packet
+    bool             keyframe;      // Next packet must be a keyframe
+    tb_stream_stats_t stats;
+} s_stream = { .lock = portMUX_INITIALIZER_UNLOCKED };
+
+// Each band ends its runs: two bytes more per band in the worst case
+#define STREAM_OUT_SIZE (sizeof(stream_pkt_hdr_t) + \
+                         DAMAGE_MAX_AREAS * sizeof(stream_rect_hdr_t) + RLE_BOUND(DISP_WIDTH * DISP_HEIGHT) + \
+                         (DAMAGE_MAX_AREAS + DISP_HEIGHT / STREAM_BAND_ROWS) * 2)
+
+/**
+ * Called after every swap: queue the frame's damage for the streamer
+ */
+static void stream_on_present(const frame_damage_t *dmg)
+{
+    if (!s_stream.task) return;
+
+    portENTER_CRITICAL(&s_stream.lock);
+    frame_damage_t *p = &s_stream.pending;
+    for (uint32_t i = 0; i < dmg->count; i++) {
+        if (p->count < DAMAGE_MAX_AREAS) {
+            p->areas[p->count++] = dmg->areas[i];
+        } else {
+            // Too many rects since the last packet → send a keyframe instead
+            s_stream.keyframe = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_stream.lock);
+
+    xTaskNotifyGive(s_stream.task);
+}
+
+/**
+ * Encode rects from the Front Buffer into s_stream.out, STREAM_BAND_ROWS
+ * rows per pin. Bands encoded after a swap show the newer frame; its
+ * damage is queued already and goes out with the next packet, so the
+ * receiver still converges. The header carries the newest generation.
+ */
+static size_t stream_encode(char type, const lv_area_t *rects, uint32_t n)
+{
+    uint8_t *o = s_stream.out;
+    stream_pkt_hdr_t *hdr = (stream_pkt_hdr_t *)o;
+    o += sizeof(*hdr);
+
+    uint32_t gen = s_front_gen;
+    for (uint32_t i = 0; i < n; i++) {
+        const lv_area_t *a = &rects[i];
+        stream_rect_hdr_t *rh = (stream_rect_hdr_t *)o;
+        o += sizeof(*rh);
+        rh->x = a->x1;
+        rh->y = a->y1;
+        rh->w = lv_area_get_width(a);
+        rh->h = lv_area_get_height(a);
+        rh->len = 0;
+        for (int y = a->y1; y <= a->y2; y += STREAM_BAND_ROWS) {
+            const int bh = (a->y2 - y + 1 < STREAM_BAND_ROWS) ? a->y2 - y + 1 : STREAM_BAND_ROWS;
+            stream_pin_rows(y, y + bh - 1);
+            gen = s_front_gen;
+            const uint16_t *front = (const uint16_t *)front_buf;
+            rh->len += rle_encode(front + y * DISP_WIDTH + a->x1, rh->w, bh, DISP_WIDTH, o + rh->len);
+            tb_front_unpin();
+        }
+        o += rh->len;
+    }
+    *hdr = (stream_pkt_hdr_t) {
+        .magic = { 'T', 'B', 'V', '1' }, .type = type,
+        .n_rects = n, .generation = gen,
+    };
+
+    return o - s_stream.out;
+}
+
+static void stream_task(void *arg)
+{
+    const lv_area_t full = { 0, 0, DISP_WIDTH - 1, DISP_HEIGHT - 1 };
+    frame_damage_t dmg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&s_stream.lock);
+        bool key = s_stream.keyframe;
+        dmg = s_stream.pending;
+        s_stream.pending.count = 0;
+        s_stream.keyframe = false;
+        portEXIT_CRITICAL(&s_stream.lock);
+        if (!key && dmg.count == 0) continue;
+
+        int64_t t0 = esp_timer_get_time();
+        size_t len = key ? stream_encode('K', &full, 1) : stream_encode('D', dmg.areas, dmg.count);
+        uint32_t enc_us = (uint32_t)(esp_timer_get_time() - t0);
+
+        if (s_stream.sink.write(s_stream.sink.ctx, s_stream.out, len) != 0) {
+            // Sink lost data → resync with a keyframe
+            s_stream.keyframe = true;
+        }
+
+        s_stream.stats.packets++;
+        s_stream.stats.keyframes += key;
+        s_stream.stats.bytes += len;
+        s_stream.stats.last_bytes = len;
+        s_stream.stats.last_encode_us = enc_us;
+        s_stream.stats.encode_us += enc_us;
+    }
+}
+
+esp_err_t tb_stream_start(const tb_stream_sink_t *sink)
+{
+    if (s_stream.task) return ESP_ERR_INVALID_STATE;
+    if (!sink || !sink->write) return ESP_ERR_INVALID_ARG;
+
+    s_stream.out = heap_caps_malloc(STREAM_OUT_SIZE, MALLOC_CAP_SPIRAM);
+    if (!s_stream.out) return ESP_ERR_NO_MEM;
+    s_stream.sink = *sink;
+    s_stream.keyframe = true;
+    s_stream.pending.count = 0;
+    memset(&s_stream.stats, 0, sizeof(s_stream.stats));
+
+    // Streamer runs on core 0 below the LVGL task
+    if (xTaskCreatePinnedToCore(stream_task, "stream", 4096, NULL, 3, &s_stream.task, 0) != pdPASS) {
+        heap_caps_free(s_stream.out);
+        s_stream.out = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(s_stream.task);     // Initial keyframe
     return ESP_OK;
 }
 
+void tb_stream_get_stats(tb_stream_stats_t *out)
+{
+    *out = s_stream.stats;
+}
+
+#endif // STREAM_ENABLE
+
+#define SCREENSHOT_TRIES 3      // Banded encodes before accepting a mixed frame
+
+/**
+ * Encode the whole Front Buffer in STREAM_BAND_ROWS bands, so a swap waits
+ * for one band at most; returns the RLE length, *gen0 / *gen1 the
+ * generations of the first and last band
+ */
+static size_t screenshot_encode(uint8_t *out, uint32_t *gen0, uint32_t *gen1)
+{
+    size_t len = 0;
+    for (int y = 0; y < DISP_HEIGHT; y += STREAM_BAND_ROWS) {
+        const int bh = (DISP_HEIGHT - y < STREAM_BAND_ROWS) ? DISP_HEIGHT - y : STREAM_BAND_ROWS;
+        stream_pin_rows(y, y + bh - 1);
+        if (y == 0) *gen0 = s_front_gen;
+        *gen1 = s_front_gen;
+        len += rle_encode((const uint16_t *)front_buf + y * DISP_WIDTH, DISP_WIDTH, bh, DISP_WIDTH,
+                          out + len);
+        tb_front_unpin();
+    }
+    return len;
+}
+
+esp_err_t tb_screenshot(const tb_stream_sink_t *sink)
+{
+    // Keyframe packet of the current Front Buffer, same format as the stream
+    size_t cap = sizeof(stream_pkt_hdr_t) + sizeof(stream_rect_hdr_t) + RLE_BOUND(DISP_WIDTH * DISP_HEIGHT) +
+                 (DISP_HEIGHT / STREAM_BAND_ROWS + 1) * 2;
+    uint8_t *out = heap_caps_malloc(cap, MALLOC_CAP_SPIRAM);
+    if (!out) return ESP_ERR_NO_MEM;
+
+    stream_pkt_hdr_t *hdr = (stream_pkt_hdr_t *)out;
+    stream_rect_hdr_t *rh = (stream_rect_hdr_t *)(hdr + 1);
+    *rh = (stream_rect_hdr_t) { .x = 0, .y = 0, .w = DISP_WIDTH, .h = DISP_HEIGHT };
+
+    // A swap between bands mixes two frames: encode again while the UI moves
+    uint32_t gen0 = 0, gen1 = 0;
+    for (int i = 0; i < SCREENSHOT_TRIES; i++) {
+        rh->len = screenshot_encode((uint8_t *)(rh + 1), &gen0, &gen1);
+        if (gen0 == gen1) break;
+    }
+    if (gen0 != gen1) ESP_LOGW(TAG, "Screenshot spans frames %u..%u", (unsigned)gen0, (unsigned)gen1);
+    *hdr = (stream_pkt_hdr_t) {
+        .magic = { 'T', 'B', 'V', '1' }, .type = 'K', .n_rects = 1, .generation = gen1,
+    };
+
+    int ret = sink->write(sink->ctx, out, sizeof(*hdr) + sizeof(*rh) + rh->len);
+    heap_caps_free(out);
+    return (ret == 0) ? ESP_OK : ESP_FAIL;
+}
+
 /* ============================================================
- * LCD RGB Panel Setup (adjust to your display!)
+ * Flush Stream Recording
  * ============================================================ */
 
-static esp_err_t lcd_panel_init(void)
+#if FLUSH_RECORD_ENABLE || FLUSH_REPLAY_ENABLE
+
+/*
+ * Log layout (little endian, 4-byte aligned, can be used straight from
+ * an esp_partition_mmap() mapping or an mmap()ed file):
+ *
+ *   flush_log_hdr_t
+ *   flush_log_rec_t [+ w*h RGB565 pixels, padded to 4 bytes]   ← AREA
+ *   flush_log_rec_t                                              ← FRAME
+ *   ...
+ *
+ * Timestamps are relative to the first record. The log is stored in a
+ * data partition labelled "flushlog" (add it to partitions.csv, ≥ 2 MB)
+ * and can be pulled with `parttool.py read_partition --partition-name flushlog`.
+ */
+#define FLUSH_LOG_MAGIC     0x4C524254  // "TBRL"
+#define FLUSH_LOG_VERSION   1
+
+enum {
+    FLUSH_REC_AREA  = 1,    // One lvgl_flush_cb strip, pixels follow
+    FLUSH_REC_FRAME = 2,    // lv_disp_flush_is_last → present_frame()
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t bpp;
+    uint16_t width;
+    uint16_t height;
+    uint32_t n_records;
+    uint32_t data_len;      // Bytes following the header
+} flush_log_hdr_t;
+
+typedef struct {
+    uint8_t  type;
+    uint8_t  reserved;
+    uint16_t x1, y1, x2, y2;
+    uint16_t reserved2;
+    uint32_t t_us;
+} flush_log_rec_t;
+
+#define FLUSH_LOG_PAD4(n)   (((n) + 3) & ~3u)
+
+static const esp_partition_t *flush_log_partition(void)
 {
-    ESP_LOGI(TAG, "Initializing RGB LCD panel...");
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "flushlog");
+    if (!part) ESP_LOGE(TAG, "No \"flushlog\" partition");
+    return part;
+}
 
-    esp_lcd_rgb_panel_config_t panel_config = {
-        .clk_src = LCD_CLK_SRC_DEFAULT,
-        .timings = {
-            .pclk_hz = 24 * 1000 * 1000,   // 24 MHz pixel clock
-            .h_res = DISP_WIDTH,
-            .v_res = DISP_HEIGHT,
-            // Adjust timing values to your display!
-            .hsync_back_porch = 20,
-            .hsync_front_porch = 40,
-            .hsync_pulse_width = 2,
-            .vsync_back_porch = 8,
-            .vsync_front_porch = 20,
-            .vsync_pulse_width = 2,
-            .flags = {
-                .pclk_active_neg = true,
-            },
-        },
-        .data_width = 16,   // 16-bit parallel RGB565
-        .num_fbs = 0,       // IMPORTANT: We manage buffers ourselves!
-        .bounce_buffer_size_px = 0,
-        // Adjust pin configuration to your board!
-        .hsync_gpio_num = -1,   // TODO: Your pins
-        .vsync_gpio_num = -1,   // TODO: Your pins
-        .de_gpio_num = -1,      // TODO: Your pins
-        .pclk_gpio_num = -1,    // TODO: Your pins
-        .disp_gpio_num = -1,
-        .data_gpio_nums = {
-            // TODO: Your 16 data pins here
-            -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1,
-        },
-        .flags = {
-            .fb_in_psram = 0,   // We manage buffers ourselves
-        },
+#endif // FLUSH_RECORD_ENABLE || FLUSH_REPLAY_ENABLE
+
+#if FLUSH_RECORD_ENABLE
+
+static uint8_t *s_log_buf = NULL;
+static size_t   s_log_len = 0;
+static int64_t  s_log_t0 = 0;
+static bool     s_log_done = false;
+static volatile bool s_log_stop = false;    // tb_flush_log_stop() → flush_log_poll()
+static size_t   s_log_frame_len;            // Log end and record count ...
+static uint32_t s_log_frame_recs;           // ... at the last FRAME record
+
+static esp_err_t flush_log_init(void)
+{
+    s_log_buf = heap_caps_aligned_alloc(FB_ALIGN, FLUSH_LOG_SIZE, MALLOC_CAP_SPIRAM);
+    if (!s_log_buf) return ESP_ERR_NO_MEM;
+
+    flush_log_hdr_t *hdr = (flush_log_hdr_t *)s_log_buf;
+    *hdr = (flush_log_hdr_t) {
+        .magic = FLUSH_LOG_MAGIC, .version = FLUSH_LOG_VERSION,
+        .bpp = DISP_BPP, .width = DISP_WIDTH, .height = DISP_HEIGHT,
+    };
+    s_log_len = s_log_frame_len = sizeof(*hdr);
+    ESP_LOGI(TAG, "Recording flush stream (%d KB buffer)", FLUSH_LOG_SIZE / 1024);
+    return ESP_OK;
+}
+
+/**
+ * Write the recorded log to the "flushlog" partition
+ */
+static void flush_log_save(void)
+{
+    const esp_partition_t *part = flush_log_partition();
+    if (!part) return;
+
+    size_t len = (s_log_len < part->size) ? s_log_len : part->size;
+    if (flash_erase_sectors(part, 0, len) != ESP_OK ||
+        flash_write_sectors(part, 0, s_log_buf, len) != ESP_OK) {
+        ESP_LOGE(TAG, "Writing flush log failed");
+        return;
+    }
+    const flush_log_hdr_t *hdr = (const flush_log_hdr_t *)s_log_buf;
+    ESP_LOGI(TAG, "Flush log saved: %u records, %u bytes",
+             (unsigned)hdr->n_records, (unsigned)len);
+}
+
+static bool flush_log_append(const flush_log_rec_t *rec, const void *payload, size_t len)
+{
+    size_t need = sizeof(*rec) + FLUSH_LOG_PAD4(len);
+    if (s_log_len + need > FLUSH_LOG_SIZE) return false;
+
+    memcpy(s_log_buf + s_log_len, rec, sizeof(*rec));
+    if (len) memcpy(s_log_buf + s_log_len + sizeof(*rec), payload, len);
+    s_log_len += need;
+
+    flush_log_hdr_t *hdr = (flush_log_hdr_t *)s_log_buf;
+    hdr->n_records++;
+    hdr->data_len = s_log_len - sizeof(*hdr);
+    return true;
+}
+
+/**
+ * End the recording at the last complete frame and save it; areas of a
+ * frame without its FRAME record would replay as a torn frame
+ */
+static void flush_log_finish(void)
+{
+    flush_log_hdr_t *hdr = (flush_log_hdr_t *)s_log_buf;
+    s_log_len = s_log_frame_len;
+    hdr->n_records = s_log_frame_recs;
+    hdr->data_len = s_log_len - sizeof(*hdr);
+    s_log_done = true;
+    flush_log_save();
+}
+
+/**
+ * Called from lvgl_flush_cb for every strip. Records stop when the buffer
+ * is full, then the log is saved up to the last complete frame.
+ */
+static void flush_log_record(const lv_area_t *area, const lv_color_t *color_map, bool last)
+{
+    if (!s_log_buf || s_log_done) return;
+
+    int64_t now = esp_timer_get_time();
+    if (s_log_t0 == 0) s_log_t0 = now;
+
+    size_t px_len = lv_area_get_size(area) * sizeof(lv_color_t);
+    flush_log_rec_t rec = {
+        .type = FLUSH_REC_AREA,
+        .x1 = area->x1, .y1 = area->y1, .x2 = area->x2, .y2 = area->y2,
+        .t_us = (uint32_t)(now - s_log_t0),
     };
+    if (!flush_log_append(&rec, color_map, px_len)) {
+        flush_log_finish();
+        return;
+    }
+    if (!last) return;
+
+    rec = (flush_log_rec_t) { .type = FLUSH_REC_FRAME, .t_us = (uint32_t)(now - s_log_t0) };
+    if (!flush_log_append(&rec, NULL, 0)) {
+        flush_log_finish();
+        return;
+    }
+    s_log_frame_len = s_log_len;
+    s_log_frame_recs = ((const flush_log_hdr_t *)s_log_buf)->n_records;
+}
+
+/**
+ * Save on request or after FLUSH_LOG_MAX_MS (LVGL task, between refreshes)
+ */
+static void flush_log_poll(void)
+{
+    if (!s_log_buf || s_log_done) return;
+    bool timeout = FLUSH_LOG_MAX_MS && s_log_t0 &&
+                   esp_timer_get_time() - s_log_t0 >= FLUSH_LOG_MAX_MS * 1000LL;
+    if (s_log_stop || timeout) flush_log_finish();
+}
+
+void tb_flush_log_stop(void)
+{
+    s_log_stop = true;
+}
+
+#else
+
+void tb_flush_log_stop(void)
+{
+}
+
+#endif // FLUSH_RECORD_ENABLE
+
+/* ============================================================
+ * LVGL Flush Callback
+ * ============================================================ */
+
+/**
+ * Copy one rendered strip into the Work Buffer
+ */
+static void flush_area(const lv_area_t *area, const lv_color_t *color_map)
+{
+    // LVGL hat einen Streifen im schnellen internen RAM gerendert.
+    // Jetzt kopieren wir nur diesen Streifen in den PSRAM Work Buffer.
+    
+    uint32_t w = area->x2 - area->x1 + 1;
+    uint32_t h = area->y2 - area->y1 + 1;
+    PROF_SCOPE(PROF_FLUSH_AREA);
+    TRACE(TRACE_FLUSH_BEGIN, h);
+    
+    // Zeilenweise in den Work Buffer (PSRAM) kopieren
+    for (int y = 0; y < h; y++) {
+        const uint16_t *src = (const uint16_t *)color_map + y * w;
+        uint16_t *dst = (uint16_t *)fb_row(work_buf, area->y1 + y) + area->x1;
+        memcpy(dst, src, w * sizeof(uint16_t));
+    }
+    s_stats.flush_bytes += w * h * sizeof(uint16_t);
+#if HYBRID_FB_ENABLE
+    int band_rows = ((area->y2 < BAND_Y1 - 1) ? area->y2 : BAND_Y1 - 1) -
+                    ((area->y1 > BAND_Y0) ? area->y1 : BAND_Y0) + 1;
+    if (band_rows > 0) s_stats.band_bytes += band_rows * w * sizeof(uint16_t);
+#endif
+    damage_add(area);
+    TRACE(TRACE_FLUSH_END, 0);
+}
+
+/**
+ * Frame complete: GDMA copy Work → Back, then swap Back ↔ Front
+ */
+static void present_frame(void)
+{
+    // Frame komplett → GDMA copy work → back, dann swap
+#if HUD_ENABLE || DAMAGE_SCHED_ENABLE
+    int64_t t_copy = esp_timer_get_time();
+#endif
+    bool patched = false;
+#if VBLANK_PATCH_ENABLE
+    patched = vblank_patch();
+#endif
+    if (!patched) {
+        fb_copy_frame(back_buf, work_buf);
+#if DAMAGE_VIS_ENABLE
+        damage_visualize(back_buf);
+#endif
+#if HUD_ENABLE
+        int64_t t_done = esp_timer_get_time();
+        hud_draw(back_buf, s_stats.last_present_us ? (uint32_t)(t_done - s_stats.last_present_us) : 0,
+                 (uint32_t)(t_done - t_copy));
+#endif
+        swap_buffers();
+    }
+#if STREAM_ENABLE
+    stream_on_present(&s_damage);
+#endif
+
+    int64_t now = esp_timer_get_time();
+#if BENCH_ENABLE
+    bench_on_present(now);
+#endif
+#if TOUCH_ENABLE
+    touch_on_present(now);
+#endif
+#if DAMAGE_SCHED_ENABLE
+    if (!patched) damage_sched_on_present(t_copy, now);    // Patches carry no copy cost
+#endif
+    s_stats.frames++;
+    s_stats.last_present_us = now;
+    s_damage.count = 0;
+    s_damage.pixels = 0;
+}
+
+#if PROF_ENABLE
+// Start of the current LVGL draw phase (render start or end of last flush)
+static esp_cpu_cycle_count_t s_prof_draw_start;
+static esp_cpu_cycle_count_t s_prof_frame_start;
+#endif
+
+/**
+ * LVGL calls this callback for each rendered region.
+ * 
+ * Since we use a full-frame Work Buffer, LVGL copies its
+ * internal render results directly into the Work Buffer.
+ * 
+ * When the last flush of a frame arrives:
+ *   1. GDMA: Copy Work → Back
+ *   2. Pointer swap: Back ↔ Front
+ */
+static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, 
+                           lv_color_t *color_map)
+{
+    bool last = lv_disp_flush_is_last(drv);
+#if PROF_ENABLE
+    esp_cpu_cycle_count_t t_flush = PROF_NOW();
+    PROF_RECORD(PROF_LV_DRAW, t_flush - s_prof_draw_start);
+#endif
+
+#if FLUSH_RECORD_ENABLE
+    flush_log_record(area, color_map, last);
+#endif
+    flush_area(area, color_map);
+
+    if (last) {
+        TRACE(TRACE_RENDER_END, 0);
+        present_frame();
+    }
+
+#if PROF_ENABLE
+    s_prof_draw_start = PROF_NOW();
+    PROF_RECORD(PROF_FLUSH_CB, s_prof_draw_start - t_flush);
+    if (last) PROF_RECORD(PROF_LV_FRAME, s_prof_draw_start - s_prof_frame_start);
+#endif
+    lv_disp_flush_ready(drv);
+}
+```
+
+## Der Unterschied
+```
+Direct Mode (vorher):
+  LVGL → random writes in PSRAM (langsam!) → GDMA → swap
+
+Partial Mode (besser):
+  LVGL → random writes in internem SRAM (schnell!)
+       → sequentieller memcpy in PSRAM (cache-freundlich)
+       → GDMA → swap
+
+/* ============================================================
+ * Flush Stream Replay
+ * ============================================================ */
+
+#if FLUSH_REPLAY_ENABLE
+
+/**
+ * Feed a recorded log through flush_area() / present_frame().
+ *
+ * Records are issued at their recorded time offsets; if the pipeline
+ * falls behind, the next record is issued immediately and the lag is
+ * reported, so slower pipeline variants show up as replay lag.
+ */
+static esp_err_t flush_log_replay(const uint8_t *log, size_t size)
+{
+    const flush_log_hdr_t *hdr = (const flush_log_hdr_t *)log;
+    if (size < sizeof(*hdr) || hdr->magic != FLUSH_LOG_MAGIC) return ESP_ERR_INVALID_ARG;
+    if (hdr->version != FLUSH_LOG_VERSION) return ESP_ERR_INVALID_VERSION;
+    if (hdr->width != DISP_WIDTH || hdr->height != DISP_HEIGHT || hdr->bpp != DISP_BPP ||
+        sizeof(*hdr) + hdr->data_len > size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *p = log + sizeof(*hdr);
+    const uint8_t *end = p + hdr->data_len;
+    uint32_t frames = 0;
+    int64_t max_lag = 0, t_last = 0;
+    int64_t t0 = esp_timer_get_time();
+    pipeline_stats_t start = s_stats;
+
+    for (uint32_t i = 0; i < hdr->n_records && p + sizeof(flush_log_rec_t) <= end; i++) {
+        flush_log_rec_t rec;
+        memcpy(&rec, p, sizeof(rec));
+        p += sizeof(rec);
+
+        // Identical timing inputs: wait for the recorded offset
+        // (sleep while more than a tick is left, spin only the last one)
+        int64_t lag = (esp_timer_get_time() - t0) - rec.t_us;
+        const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+        for (int64_t left = -lag; left > tick_us; left = rec.t_us - (esp_timer_get_time() - t0)) {
+            TickType_t n = (TickType_t)(left / tick_us) - 1;
+            vTaskDelay(n ? n : 1);      // Ends anywhere in the tick, so one short
+        }
+        while (esp_timer_get_time() - t0 < rec.t_us) { }
+        if (lag > max_lag) max_lag = lag;
+
+        if (rec.type == FLUSH_REC_AREA) {
+            lv_area_t area = { rec.x1, rec.y1, rec.x2, rec.y2 };
+            size_t len = lv_area_get_size(&area) * sizeof(lv_color_t);
+            if (p + len > end || area.x2 >= DISP_WIDTH || area.y2 >= DISP_HEIGHT) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            flush_area(&area, (const lv_color_t *)p);
+            p += FLUSH_LOG_PAD4(len);
+        } else if (rec.type == FLUSH_REC_FRAME) {
+            present_frame();
+            frames++;
+        }
+        t_last = rec.t_us;
+    }
+
+    int64_t dur = esp_timer_get_time() - t0;
+    ESP_LOGI(TAG, "Replay: %u frames, recorded %.1f ms, replayed %.1f ms, max lag %.1f ms, "
+             "copy wait %.1f ms", (unsigned)frames, t_last / 1000.0f, dur / 1000.0f,
+             max_lag / 1000.0f, (s_stats.copy_wait_us - start.copy_wait_us) / 1000.0f);
+    return ESP_OK;
+}
+
+/**
+ * Replay the "flushlog" partition in a loop (runs instead of LVGL)
+ */
+static void flush_replay_task(void *arg)
+{
+    const esp_partition_t *part = flush_log_partition();
+    const void *log = NULL;
+    esp_partition_mmap_handle_t map;
+    if (!part || esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                                    &log, &map) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot map flush log");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (1) {
+        esp_err_t ret = flush_log_replay(log, part->size);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Invalid flush log (0x%x)", ret);
+            break;
+        }
+#if TRACE_ENABLE
+        if (!s_trace_stopped) trace_dump_json();
+#endif
+    }
+    esp_partition_munmap(map);
+    vTaskDelete(NULL);
+}
+
+#endif // FLUSH_REPLAY_ENABLE
+
+/* ============================================================
+ * Buffer Allocation
+ * ============================================================ */
+
+static esp_err_t allocate_buffers(void)
+{
+    // All 3 buffers in PSRAM, cache-aligned
+    work_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
+    front_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
+    back_buf = (uint8_t *)heap_caps_aligned_alloc(FB_ALIGN, FB_SIZE, MALLOC_CAP_SPIRAM);
+
+    if (!work_buf || !front_buf || !back_buf) {
+        ESP_LOGE(TAG, "Buffer allocation failed! Need 3x %d bytes PSRAM", FB_SIZE);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Clear buffers (black screen)
+    memset(work_buf, 0, FB_SIZE);
+    memset(front_buf, 0, FB_SIZE);
+    memset(back_buf, 0, FB_SIZE);
+
+#if HYBRID_FB_ENABLE
+    s_band_fb[0] = work_buf;
+    s_band_fb[1] = front_buf;
+    s_band_fb[2] = back_buf;
+    for (int i = 0; i < 3; i++) {
+        s_band[i] = heap_caps_calloc(1, BAND_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+        if (!s_band[i]) {
+            ESP_LOGE(TAG, "Hybrid band allocation failed! Need 3x %d bytes internal RAM", BAND_BYTES);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGI(TAG, "Hybrid band: rows %d-%d in internal RAM (3x %d bytes)",
+             BAND_Y0, BAND_Y1 - 1, BAND_BYTES);
+#endif
+
+    ESP_LOGI(TAG, "3 framebuffers allocated: %d bytes each (%.1f MB total)", 
+             FB_SIZE, (3.0f * FB_SIZE) / (1024.0f * 1024.0f));
+    
+    return ESP_OK;
+}
+
+/* ============================================================
+ * Suspend / Resume Snapshot
+ * ============================================================ */
+
+#if SNAPSHOT_ENABLE
+
+/*
+ * tb_display_suspend() RLE-compresses the Front Buffer into the "fbsnap"
+ * data partition (add it to partitions.csv, ≥ 1.1 MB for the worst case).
+ * PSRAM does not survive deep sleep, flash does. On wake from deep sleep,
+ * snapshot_restore() decodes it straight into the Front Buffer before the
+ * panel and LVGL are initialized, so the last frame is back on screen
+ * immediately instead of after LVGL's first full render.
+ *
+ * The partition is erased in the background after a restore, so the next
+ * suspend only has to write (sector erase dominates flash write time).
+ */
+#define SNAPSHOT_MAGIC  0x50414E53  // "SNAP"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint32_t len;           // RLE bytes following the header
+    uint32_t crc;           // CRC32 of the RLE bytes
+} snapshot_hdr_t;
+
+static const esp_partition_t *snapshot_partition(void)
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "fbsnap");
+}
+
+/**
+ * Whether the first len bytes are blank. The header alone says nothing:
+ * an interrupted erase or suspend leaves it blank and later sectors not.
+ */
+static bool snapshot_is_erased(const esp_partition_t *part, size_t len)
+{
+    const void *map = NULL;
+    esp_partition_mmap_handle_t map_handle;
+    if (esp_partition_mmap(part, 0, len, ESP_PARTITION_MMAP_DATA, &map, &map_handle) != ESP_OK) {
+        return false;
+    }
+    const uint32_t *w = map;
+    size_t i = 0;
+    while (i < len / 4 && w[i] == 0xFFFFFFFF) i++;
+    bool blank = (i == len / 4);
+    for (i *= 4; blank && i < len; i++) blank = ((const uint8_t *)map)[i] == 0xFF;
+    esp_partition_munmap(map_handle);
+    return blank;
+}
+
+esp_err_t tb_display_suspend(void)
+{
+    const esp_partition_t *part = snapshot_partition();
+    if (!part) return ESP_ERR_NOT_FOUND;
+
+    uint8_t *buf = heap_caps_malloc(sizeof(snapshot_hdr_t) + RLE_BOUND(DISP_WIDTH * DISP_HEIGHT),
+                                    MALLOC_CAP_SPIRAM);
+    if (!buf) return ESP_ERR_NO_MEM;
+
+    // Stays pinned on success: the display is frozen on this frame until deep sleep
+    tb_front_pin();
+    int64_t t0 = esp_timer_get_time();
+    snapshot_hdr_t *hdr = (snapshot_hdr_t *)buf;
+    hdr->magic = SNAPSHOT_MAGIC;
+    hdr->width = DISP_WIDTH;
+    hdr->height = DISP_HEIGHT;
+    hdr->len = rle_encode((const uint16_t *)front_buf, DISP_WIDTH, DISP_HEIGHT, DISP_WIDTH,
+                          buf + sizeof(*hdr));
+    hdr->crc = esp_rom_crc32_le(0, buf + sizeof(*hdr), hdr->len);
+    int64_t t1 = esp_timer_get_time();
+
+    esp_err_t ret = ESP_OK;
+    size_t len = sizeof(*hdr) + hdr->len;
+    if (len > part->size) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else {
+        if (!snapshot_is_erased(part, len)) ret = flash_erase_sectors(part, 0, len);
+        // Header last, so an interrupted write never looks valid
+        if (ret == ESP_OK) ret = flash_write_sectors(part, sizeof(*hdr), buf + sizeof(*hdr), hdr->len);
+        if (ret == ESP_OK) ret = flash_write_sectors(part, 0, hdr, sizeof(*hdr));
+    }
+
+    ESP_LOGI(TAG, "Snapshot: %u -> %u bytes (%.1f%%), encode %.1f ms, write %.1f ms",
+             (unsigned)FB_SIZE, (unsigned)len, 100.0f * len / FB_SIZE,
+             (t1 - t0) / 1000.0f, (esp_timer_get_time() - t1) / 1000.0f);
+    heap_caps_free(buf);
+    // Not suspending after all: let the pipeline swap again
+    if (ret != ESP_OK) tb_front_unpin();
+    return ret;
+}
+
+static void snapshot_erase_task(void *arg)
+{
+    const esp_partition_t *part = arg;
+    flash_erase_sectors(part, 0, part->size);
+    vTaskDelete(NULL);
+}
+
+/**
+ * Decode a valid snapshot into fb (only after a deep-sleep wake)
+ */
+static bool snapshot_restore(uint8_t *fb)
+{
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) return false;
+
+    const esp_partition_t *part = snapshot_partition();
+    const void *map = NULL;
+    esp_partition_mmap_handle_t map_handle;
+    if (!part || esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                                    &map, &map_handle) != ESP_OK) {
+        return false;
+    }
+
+    const snapshot_hdr_t *hdr = map;
+    const uint8_t *data = (const uint8_t *)(hdr + 1);
+    bool ok = hdr->magic == SNAPSHOT_MAGIC && hdr->width == DISP_WIDTH &&
+              hdr->height == DISP_HEIGHT && hdr->len <= part->size - sizeof(*hdr) &&
+              esp_rom_crc32_le(0, data, hdr->len) == hdr->crc;
+    if (ok) {
+        int64_t t0 = esp_timer_get_time();
+        ok = rle_decode(data, hdr->len, (uint16_t *)fb, DISP_WIDTH, DISP_HEIGHT, DISP_WIDTH);
+#if HYBRID_FB_ENABLE
+        memcpy(fb_band(fb), fb + BAND_Y0 * ROW_BYTES, BAND_BYTES);
+#endif
+        int64_t dt = esp_timer_get_time() - t0;
+        esp_cache_msync(fb, FB_SIZE, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+        ESP_LOGI(TAG, "Snapshot restored: %u bytes in %.2f ms (%.1f MB/s decoded)",
+                 (unsigned)hdr->len, dt / 1000.0f, dt ? FB_SIZE / (float)dt : 0.0f);
+    }
+    esp_partition_munmap(map_handle);
+
+    if (ok) {
+        // Consumed → erase for the next suspend while the UI starts up
+        xTaskCreatePinnedToCore(snapshot_erase_task, "snap_erase", 2048, (void *)part, 1, NULL, 0);
+    }
+    return ok;
+}
+
+#endif // SNAPSHOT_ENABLE
+
+/* ============================================================
+ * Bandwidth Planner
+ * ============================================================ */
+
+/*
+ * Picks the panel timing at init from the PANEL_* ranges: shortest
+ * horizontal blanking, then the lowest PCLK that reaches PANEL_TARGET_HZ.
+ * If PANEL_PCLK_MIN_HZ would be faster than that, the vertical front porch
+ * is stretched instead (vertical blanking costs no bandwidth). The PSRAM
+ * budget is then split into scanout, the copy pipeline (flush + GDMA
+ * read + write, full frames at PLAN_PIPELINE_FPS) and what is left.
+ */
+
+/**
+ * Bounce buffer height that bridges stall_us at the planned timing
+ * (a divisor of DISP_HEIGHT, so the buffers tile the frame)
+ */
+static uint16_t plan_bounce_lines(const tb_timing_plan_t *p, uint32_t stall_us)
+{
+    _Static_assert(2 * BOUNCE_LINES * ROW_BYTES <= PLAN_BOUNCE_RAM_MAX, "default bounce size over budget");
+    const float line_us = (DISP_WIDTH + p->hpw + p->hbp + p->hfp) * 1e6f / p->pclk_hz;
+    const uint32_t max = PLAN_BOUNCE_RAM_MAX / (2 * ROW_BYTES);
+    uint32_t lines = BOUNCE_LINES;
+    while (lines < max && (lines * line_us < stall_us || DISP_HEIGHT % lines)) lines++;
+    while (DISP_HEIGHT % lines) lines--;
+    if (lines * line_us < stall_us) {
+        ESP_LOGW(TAG, "Stall of %u us needs more bounce lines than PLAN_BOUNCE_RAM_MAX allows (%u)",
+                 (unsigned)stall_us, (unsigned)lines);
+    }
+    return lines;
+}
+
+static void plan_timing(void)
+{
+    tb_timing_plan_t *p = &s_plan;
+    p->hpw = PANEL_HPW_MIN;
+    p->hbp = PANEL_HBP_MIN;
+    p->hfp = PANEL_HFP_MIN;
+    p->vpw = PANEL_VPW_MIN;
+    p->vbp = PANEL_VBP_MIN;
+    p->vfp = PANEL_VFP_MIN;
+
+    const uint32_t htotal = DISP_WIDTH + p->hpw + p->hbp + p->hfp;
+    uint32_t vtotal = DISP_HEIGHT + p->vpw + p->vbp + p->vfp;
+    uint64_t pclk = (uint64_t)PANEL_TARGET_HZ * htotal * vtotal;
+    if (pclk > PANEL_PCLK_MAX_HZ) {
+        pclk = PANEL_PCLK_MAX_HZ;
+    } else if (pclk < PANEL_PCLK_MIN_HZ) {
+        pclk = PANEL_PCLK_MIN_HZ;
+        uint32_t v = pclk / ((uint64_t)PANEL_TARGET_HZ * htotal);
+        uint32_t vfp = v - DISP_HEIGHT - p->vpw - p->vbp;
+        p->vfp = (vfp > PANEL_VFP_MAX) ? PANEL_VFP_MAX : vfp;
+        vtotal = DISP_HEIGHT + p->vpw + p->vbp + p->vfp;
+    }
+    p->pclk_hz = (uint32_t)pclk;
+    p->refresh_hz = (float)pclk / ((float)htotal * vtotal);
+
+    p->psram_bw    = (uint32_t)((uint64_t)PSRAM_CLK_MHZ * 1000000 * PSRAM_BITS_PER_CLK / 8 *
+                                PSRAM_EFFICIENCY_PCT / 100);
+    if (s_calib.gdma_bw) p->psram_bw = 2 * s_calib.gdma_bw;    // Measured: GDMA reads + writes
+    p->scanout_bw  = (uint32_t)(p->refresh_hz * FB_SIZE);
+    p->pipeline_bw = PLAN_PIPELINE_FPS * 3 * FB_SIZE;
+    p->spare_bw    = (int32_t)(p->psram_bw - p->scanout_bw - p->pipeline_bw);
+    p->feasible    = p->spare_bw >= 0 && p->refresh_hz >= PANEL_TARGET_HZ * 0.95f;
+
+    // LCD_CAM reads at 2 bytes per PCLK during a line; above the peak
+    // share it needs bounce buffers that cover the worst PSRAM stall
+    const bool need_bounce = (uint64_t)p->pclk_hz * DISP_BPP * 100 >
+                             (uint64_t)p->psram_bw * PLAN_SCANOUT_PEAK_PCT;
+    const uint32_t stall_us = s_calib.stall_us ? s_calib.stall_us : PLAN_MAX_STALL_US;
+    p->bounce_lines = (SCANOUT_BOUNCE || need_bounce) ? plan_bounce_lines(p, stall_us) : 0;
+
+    ESP_LOGI(TAG, "Plan: %dx%d @ %.1f Hz, PCLK %.2f MHz, H %u/%u/%u, V %u/%u/%u, bounce %u lines",
+             DISP_WIDTH, DISP_HEIGHT, p->refresh_hz, p->pclk_hz / 1e6f,
+             p->hpw, p->hbp, p->hfp, p->vpw, p->vbp, p->vfp, (unsigned)p->bounce_lines);
+    ESP_LOGI(TAG, "PSRAM budget: %.1f MB/s usable (%s) = scanout %.1f "
+             "+ pipeline %.1f (%d fps x 3) + spare %.1f MB/s",
+             p->psram_bw / 1e6f, s_calib.gdma_bw ? "measured" : "estimated",
+             p->scanout_bw / 1e6f, p->pipeline_bw / 1e6f, PLAN_PIPELINE_FPS, p->spare_bw / 1e6f);
+    if (!p->feasible) {
+        ESP_LOGW(TAG, "Plan not feasible: lower PANEL_TARGET_HZ or PLAN_PIPELINE_FPS");
+    }
+    if (need_bounce && !SCANOUT_BOUNCE) {
+        ESP_LOGW(TAG, "Scanout peak %.1f MB/s needs bounce buffers: enable FLASH_SAFE_ENABLE",
+                 p->pclk_hz * DISP_BPP / 1e6f);
+    }
+}
+
+const tb_timing_plan_t *tb_get_timing_plan(void)
+{
+    return &s_plan;
+}
+
+#if TOUCH_ENABLE || DAMAGE_SCHED_ENABLE
+/**
+ * First vsync at or after t (from the last one and the planned refresh)
+ */
+static int64_t vsync_next(int64_t t)
+{
+    const uint32_t period = (uint32_t)(1e6f / s_plan.refresh_hz);
+    const uint32_t since = (uint32_t)t - s_vsync_us;
+    return t + (period - since % period) % period;
+}
+#endif
+
+/* ============================================================
+ * Vblank Patching
+ * ============================================================ */
+
+/*
+ * A blinking cursor or a status icon changes a few hundred pixels, yet a
+ * frame costs a full copy Work → Back (FB_SIZE read + write in PSRAM).
+ * With VBLANK_PATCH_ENABLE a frame whose damage stays below
+ * VBLANK_PATCH_MAX_PX is copied area by area from the Work Buffer into
+ * the Front Buffer right after the vsync interrupt; no GDMA copy, no swap.
+ * The Back Buffer is left stale, the next full copy overwrites it anyway.
+ *
+ * Scanout reads row y about (vbp + y - lead) lines after the vsync, where
+ * lead is the read-ahead: the two bounce buffers filled before the frame
+ * starts, or VBLANK_PATCH_LEAD_LINES without bounce buffers. An area
+ * above the lead was already read: patched now, it shows whole in the next
+ * frame. An area below must be written before the scan reaches it. The
+ * whole sequence is scheduled before the first write: if an area straddles
+ * the lead or any deadline would be missed, nothing is written and the
+ * frame takes the full pipeline. Every write is checked against its
+ * deadline afterwards (torn, should stay 0).
+ *
+ * The wait for the vsync blocks the LVGL task for up to one refresh.
+ * The HUD and damage tints are only drawn on full frames.
+ */
+#if VBLANK_PATCH_ENABLE
+
+static struct {
+    SemaphoreHandle_t sem;          // Given by lcd_vsync_cb while armed
+    volatile bool     armed;
+    tb_vblank_stats_t st;
+} s_vblank;
+
+/**
+ * Bounce buffer height actually installed (the plan may ask for bounce
+ * buffers the build does not scan out through)
+ */
+static int vblank_bounce_lines(void)
+{
+    return SCANOUT_BOUNCE ? s_plan.bounce_lines : 0;
+}
+
+/**
+ * Rows already read by scanout when the vsync interrupt arrives
+ */
+static int vblank_lead_lines(void)
+{
+    return vblank_bounce_lines() ? 2 * vblank_bounce_lines() : VBLANK_PATCH_LEAD_LINES;
+}
+
+/**
+ * Time from the vsync until scanout reads row y, < 0 if already read
+ */
+static int32_t vblank_read_us(int y, float line_us)
+{
+    // Bounce buffers are refilled a whole block at a time
+    if (vblank_bounce_lines()) y -= y % vblank_bounce_lines();
+    const int lines = s_plan.vbp + y - vblank_lead_lines();
+    return (y < vblank_lead_lines()) ? -1 : (int32_t)(lines * line_us);
+}
+
+/**
+ * Patch the current frame's damage into the Front Buffer, false = take
+ * the full pipeline (nothing written then)
+ */
+static bool vblank_patch(void)
+{
+    const frame_damage_t *d = &s_damage;
+    if (!s_vblank.sem || !d->count || d->pixels > VBLANK_PATCH_MAX_PX ||
+        d->count >= DAMAGE_MAX_AREAS) {     // Last area may be a merged bounding box
+        return false;
+    }
+
+    const uint32_t htotal = DISP_WIDTH + s_plan.hpw + s_plan.hbp + s_plan.hfp;
+    const float line_us = htotal * 1e6f / s_plan.pclk_hz;
+    const uint32_t bw = s_calib.cpu_write_bw ? s_calib.cpu_write_bw : s_plan.psram_bw / 4;
+
+    // Order by deadline, areas already read last; straddling ones can't be patched
+    uint8_t order[DAMAGE_MAX_AREAS];
+    int32_t due[DAMAGE_MAX_AREAS];
+    for (uint32_t i = 0; i < d->count; i++) {
+        const lv_area_t *a = &d->areas[i];
+        if (a->y1 < vblank_lead_lines() && a->y2 >= vblank_lead_lines()) {
+            s_vblank.st.straddled++;
+            return false;
+        }
+        due[i] = vblank_read_us(a->y1, line_us);
+        uint32_t j = i;
+        for (; j > 0; j--) {
+            const int32_t prev = due[order[j - 1]];
+            if (due[i] < 0 || (prev >= 0 && prev <= due[i])) break;
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    xSemaphoreTake(s_vblank.sem, 0);
+    s_vblank.armed = true;
+    const TickType_t timeout = pdMS_TO_TICKS((uint32_t)(2000 / s_plan.refresh_hz)) + 1;
+    bool ok = xSemaphoreTake(s_vblank.sem, timeout) == pdTRUE;
+    s_vblank.armed = false;
+    if (!ok) return false;
+    const uint32_t vsync = s_vsync_us;
+
+    // Pin and gate only once the vsync is here; waiting for them eats into
+    // the window, which the schedule below accounts for
+#if FLASH_SAFE_ENABLE
+    flash_gate_enter();
+#endif
+    if (s_front_pin) xSemaphoreTake(s_front_pin, portMAX_DELAY);
+
+    // All or nothing: every deadline must hold for the whole sequence
+    // before the first pixel is written, else the frame would show mixed
+    int32_t t = (int32_t)((uint32_t)esp_timer_get_time() - vsync);
+    for (uint32_t n = 0; n < d->count; n++) {
+        const lv_area_t *a = &d->areas[order[n]];
+        t += (int32_t)(2ULL * lv_area_get_size(a) * sizeof(lv_color_t) * 1000000 / bw);  // Read + write
+        if (due[order[n]] >= 0 && t > due[order[n]]) {
+            s_vblank.st.missed++;
+            ok = false;
+            break;
+        }
+    }
+
+    uint32_t written = 0;
+    for (uint32_t n = 0; ok && n < d->count; n++) {
+        const lv_area_t *a = &d->areas[order[n]];
+        const int32_t deadline = due[order[n]];
+        const uint32_t row_bytes = lv_area_get_width(a) * sizeof(lv_color_t);
+        for (int y = a->y1; y <= a->y2; y++) {
+            uint8_t *dst = fb_row(front_buf, y) + a->x1 * sizeof(lv_color_t);
+            memcpy(dst, fb_row(work_buf, y) + a->x1 * sizeof(lv_color_t), row_bytes);
+#if !SCANOUT_BOUNCE
+            // LCD_CAM reads PSRAM past the cache
+            esp_cache_msync(dst, row_bytes, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+#endif
+        }
+        if (deadline >= 0 && (int32_t)((uint32_t)esp_timer_get_time() - vsync) > deadline) {
+            s_vblank.st.torn++;
+        }
+        written += lv_area_get_size(a);
+    }
+    if (ok) {
+        s_front_gen++;
+#if HYBRID_FB_ENABLE
+        if (s_swap_cb) fb_band_store(front_buf);
+#endif
+    }
+
+    if (s_front_pin) xSemaphoreGive(s_front_pin);
+#if FLASH_SAFE_ENABLE
+    flash_gate_leave();
+#endif
+    if (!ok) return false;
+
+    s_stats.flush_bytes += 2 * written * sizeof(lv_color_t);    // Same path as a flush
+    s_vblank.st.patches++;
+    s_vblank.st.patched_px += written;
+    TRACE(TRACE_SWAP, 1);
+    if (s_swap_cb) s_swap_cb(s_front_gen, (const uint16_t *)front_buf, s_swap_cb_ctx);
+    return true;
+}
+
+void tb_vblank_get_stats(tb_vblank_stats_t *out)
+{
+    *out = s_vblank.st;
+}
+
+static void vblank_log(void)
+{
+    const tb_vblank_stats_t *st = &s_vblank.st;
+    ESP_LOGI(TAG, "Vblank: %u patches (%u px), %u missed, %u straddled, %u torn",
+             (unsigned)st->patches, (unsigned)st->patched_px, (unsigned)st->missed,
+             (unsigned)st->straddled, (unsigned)st->torn);
+    if (st->torn) ESP_LOGW(TAG, "Vblank patches were late: lower VBLANK_PATCH_MAX_PX");
+}
+
+#else
+
+void tb_vblank_get_stats(tb_vblank_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // VBLANK_PATCH_ENABLE
+
+/* ============================================================
+ * LCD RGB Panel Setup (adjust to your display!)
+ * ============================================================ */
+
+/**
+ * ISR Callback - LCD_CAM starts a new frame
+ */
+static IRAM_ATTR bool lcd_vsync_cb(esp_lcd_panel_handle_t panel,
+                                   const esp_lcd_rgb_panel_event_data_t *edata,
+                                   void *user_ctx)
+{
+    TRACE(TRACE_VSYNC, 0);
+    s_vsync_count++;
+    s_vsync_us = (uint32_t)esp_timer_get_time();
+#if VBLANK_PATCH_ENABLE
+    if (s_vblank.armed) {
+        BaseType_t high_task_wakeup = pdFALSE;
+        s_vblank.armed = false;
+        xSemaphoreGiveFromISR(s_vblank.sem, &high_task_wakeup);
+        return (high_task_wakeup == pdTRUE);
+    }
+#endif
+    return false;
+}
+
+#if SCANOUT_BOUNCE
+static const uint8_t *s_scan_buf = NULL;    // Front Buffer latched at frame start
+
+/**
+ * ISR Callback - refill a bounce buffer from the Front Buffer, by row
+ */
+static IRAM_ATTR bool lcd_bounce_fill_cb(esp_lcd_panel_handle_t panel, void *bounce_buf,
+                                         int pos_px, int len_bytes, void *user_ctx)
+{
+    // Latch once per frame: a swap in the middle would tear
+    if (pos_px == 0) s_scan_buf = front_buf;
+    bool psram_ok = true;
+#if FLASH_SAFE_ENABLE
+    s_flash_safe.refills++;
+    psram_ok = spi_flash_cache_enabled();
+    if (!psram_ok) s_flash_safe.held_refills++;
+#endif
+    uint8_t *dst = bounce_buf;
+    for (int y = pos_px / DISP_WIDTH; len_bytes > 0; y++, dst += ROW_BYTES, len_bytes -= ROW_BYTES) {
+        const uint8_t *src = fb_row(s_scan_buf, y);
+#if HYBRID_FB_ENABLE
+        if (y >= BAND_Y0 && y < BAND_Y1) {
+            memcpy(dst, src, ROW_BYTES);
+            s_band_scan_bytes += ROW_BYTES;
+            continue;
+        }
+#endif
+        // Without PSRAM (cache off) the row already in there is repeated
+        if (psram_ok) memcpy(dst, src, ROW_BYTES);
+    }
+    return false;
+}
+#endif
+
+static esp_err_t lcd_panel_init(void)
+{
+    ESP_LOGI(TAG, "Initializing RGB LCD panel...");
+    plan_timing();
+
+    esp_lcd_rgb_panel_config_t panel_config = {
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .timings = {
+            .pclk_hz = s_plan.pclk_hz,
+            .h_res = DISP_WIDTH,
+            .v_res = DISP_HEIGHT,
+            // Chosen by plan_timing() from the PANEL_* ranges
+            .hsync_back_porch = s_plan.hbp,
+            .hsync_front_porch = s_plan.hfp,
+            .hsync_pulse_width = s_plan.hpw,
+            .vsync_back_porch = s_plan.vbp,
+            .vsync_front_porch = s_plan.vfp,
+            .vsync_pulse_width = s_plan.vpw,
+            .flags = {
+                .pclk_active_neg = true,
+            },
+        },
+        .data_width = 16,   // 16-bit parallel RGB565
+        .num_fbs = 0,       // IMPORTANT: We manage buffers ourselves!
+#if SCANOUT_BOUNCE
+        .bounce_buffer_size_px = DISP_WIDTH * s_plan.bounce_lines,
+#else
+        .bounce_buffer_size_px = 0,
+#endif
+        // Adjust pin configuration to your board!
+        .hsync_gpio_num = -1,   // TODO: Your pins
+        .vsync_gpio_num = -1,   // TODO: Your pins
+        .de_gpio_num = -1,      // TODO: Your pins
+        .pclk_gpio_num = -1,    // TODO: Your pins
+        .disp_gpio_num = -1,
+        .data_gpio_nums = {
+            // TODO: Your 16 data pins here
+            -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1,
+        },
+        .flags = {
+            .fb_in_psram = 0,   // We manage buffers ourselves
+#if SCANOUT_BOUNCE
+            .no_fb = 1,         // Scanout only through lcd_bounce_fill_cb
+#endif
+        },
+    };
+
+    esp_err_t ret = esp_lcd_new_rgb_panel(&panel_config, &s_panel_handle);
+#if SCANOUT_BOUNCE
+    if (ret != ESP_OK && s_plan.bounce_lines != BOUNCE_LINES) {
+        // Planned bounce buffers don't fit the internal RAM: default size
+        ESP_LOGW(TAG, "Panel with %u bounce lines failed (0x%x), retrying with %d",
+                 (unsigned)s_plan.bounce_lines, ret, BOUNCE_LINES);
+        s_plan.bounce_lines = BOUNCE_LINES;
+        panel_config.bounce_buffer_size_px = DISP_WIDTH * BOUNCE_LINES;
+        ret = esp_lcd_new_rgb_panel(&panel_config, &s_panel_handle);
+    }
+#endif
+    ESP_RETURN_ON_ERROR(ret, TAG, "RGB panel creation failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_reset(s_panel_handle), TAG, "Panel reset failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_init(s_panel_handle), TAG, "Panel init failed");
+
+    esp_lcd_rgb_panel_event_callbacks_t cbs = {
+        .on_vsync = lcd_vsync_cb,
+#if SCANOUT_BOUNCE
+        .on_bounce_empty = lcd_bounce_fill_cb,
+#endif
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_rgb_panel_register_event_callbacks(s_panel_handle, &cbs, NULL),
+                        TAG, "Panel callback registration failed");
+
+    return ESP_OK;
+}
+
+/* ============================================================
+ * LVGL Memory Backend
+ * ============================================================ */
+
+#if LVMEM_ENABLE
+
+/*
+ * Replaces LVGL's single heap. In lv_conf.h:
+ *
+ *   #define LV_MEM_CUSTOM          1
+ *   #define LV_MEM_CUSTOM_INCLUDE  "triplebuffer.h"
+ *   #define LV_MEM_CUSTOM_ALLOC    tb_lv_malloc
+ *   #define LV_MEM_CUSTOM_FREE     tb_lv_free
+ *   #define LV_MEM_CUSTOM_REALLOC  tb_lv_realloc
+ *
+ *   ≤ 256 B        → size-class pools in internal RAM (O(1) free lists)
+ *   ≤ PSRAM_MIN    → TLSF region in internal RAM (multi_heap)
+ *   > PSRAM_MIN    → PSRAM (image data, big canvases)
+ *
+ * A full pool spills into the TLSF region, a full TLSF region into PSRAM.
+ * The owner of a pointer is found by its address range. LVGL calls these
+ * from one task only (lv_init in app_main, then the LVGL task), so there
+ * is no locking; the statistics may be read from anywhere.
+ */
+static const uint16_t s_lvmem_class_size[TB_LVMEM_CLASSES]   = { 16, 32, 64, 128, 256 };
+static const uint16_t s_lvmem_class_blocks[TB_LVMEM_CLASSES] = { 256, 256, 128, 64, 32 };
+
+typedef struct lvmem_free {
+    struct lvmem_free *next;
+} lvmem_free_t;
+
+static struct {
+    bool               ready;
+    uint8_t           *pool_start[TB_LVMEM_CLASSES];
+    uint8_t           *pool_end[TB_LVMEM_CLASSES];
+    lvmem_free_t      *free_list[TB_LVMEM_CLASSES];
+    uint8_t           *heap_start, *heap_end;
+    multi_heap_handle_t heap;
+    tb_lvmem_stats_t   stats;
+} s_lvmem;
+
+static void lvmem_init(void)
+{
+    size_t pool_bytes = 0;
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) {
+        pool_bytes += s_lvmem_class_size[c] * s_lvmem_class_blocks[c];
+    }
+    uint8_t *mem = heap_caps_malloc(pool_bytes + LVMEM_HEAP_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_lvmem.ready = true;
+    if (!mem) {
+        ESP_LOGE(TAG, "LVGL memory pools: no internal RAM, using PSRAM only");
+        return;
+    }
+
+    // Carve the class pools and thread their free lists
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) {
+        s_lvmem.pool_start[c] = mem;
+        for (int i = s_lvmem_class_blocks[c] - 1; i >= 0; i--) {
+            lvmem_free_t *blk = (lvmem_free_t *)(mem + i * s_lvmem_class_size[c]);
+            blk->next = s_lvmem.free_list[c];
+            s_lvmem.free_list[c] = blk;
+        }
+        mem += s_lvmem_class_size[c] * s_lvmem_class_blocks[c];
+        s_lvmem.pool_end[c] = mem;
+    }
+
+    s_lvmem.heap_start = mem;
+    s_lvmem.heap_end = mem + LVMEM_HEAP_SIZE;
+    s_lvmem.heap = multi_heap_register(mem, LVMEM_HEAP_SIZE);
+}
+
+static int lvmem_class_of_ptr(const void *p)
+{
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) {
+        if ((const uint8_t *)p >= s_lvmem.pool_start[c] && (const uint8_t *)p < s_lvmem.pool_end[c]) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+static inline bool lvmem_in_heap(const void *p)
+{
+    return (const uint8_t *)p >= s_lvmem.heap_start && (const uint8_t *)p < s_lvmem.heap_end;
+}
+
+static void lvmem_count_alloc(tb_lvmem_class_stats_t *s, size_t bytes)
+{
+    s->allocs++;
+    s->in_use++;
+    s->bytes_in_use += bytes;
+    if (s->in_use > s->high_water) s->high_water = s->in_use;
+    if (s->bytes_in_use > s->bytes_high_water) s->bytes_high_water = s->bytes_in_use;
+}
+
+static void lvmem_count_free(tb_lvmem_class_stats_t *s, size_t bytes)
+{
+    s->frees++;
+    s->in_use--;
+    s->bytes_in_use -= bytes;
+}
+
+void *tb_lv_malloc(size_t size)
+{
+    if (!s_lvmem.ready) lvmem_init();
+    if (size == 0) size = 1;
+
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) {
+        if (size > s_lvmem_class_size[c]) continue;
+        lvmem_free_t *blk = s_lvmem.free_list[c];
+        if (blk) {
+            s_lvmem.free_list[c] = blk->next;
+            lvmem_count_alloc(&s_lvmem.stats.cls[c], s_lvmem_class_size[c]);
+            return blk;
+        }
+        s_lvmem.stats.cls[c].spills++;  // Pool exhausted → fall through
+        break;
+    }
+
+    if (size < LVMEM_PSRAM_MIN && s_lvmem.heap) {
+        void *p = multi_heap_malloc(s_lvmem.heap, size);
+        if (p) {
+            lvmem_count_alloc(&s_lvmem.stats.heap, multi_heap_get_allocated_size(s_lvmem.heap, p));
+            return p;
+        }
+        s_lvmem.stats.heap.spills++;
+    }
+
+    void *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (p) lvmem_count_alloc(&s_lvmem.stats.psram, heap_caps_get_allocated_size(p));
+    return p;
+}
+
+void tb_lv_free(void *p)
+{
+    if (!p) return;
+
+    int c = lvmem_class_of_ptr(p);
+    if (c >= 0) {
+        lvmem_free_t *blk = p;
+        blk->next = s_lvmem.free_list[c];
+        s_lvmem.free_list[c] = blk;
+        lvmem_count_free(&s_lvmem.stats.cls[c], s_lvmem_class_size[c]);
+    } else if (lvmem_in_heap(p)) {
+        lvmem_count_free(&s_lvmem.stats.heap, multi_heap_get_allocated_size(s_lvmem.heap, p));
+        multi_heap_free(s_lvmem.heap, p);
+    } else {
+        lvmem_count_free(&s_lvmem.stats.psram, heap_caps_get_allocated_size(p));
+        heap_caps_free(p);
+    }
+}
+
+void *tb_lv_realloc(void *p, size_t size)
+{
+    if (!p) return tb_lv_malloc(size);
+    if (size == 0) {
+        tb_lv_free(p);
+        return NULL;
+    }
+
+    size_t old;
+    int c = lvmem_class_of_ptr(p);
+    if (c >= 0) {
+        old = s_lvmem_class_size[c];
+        // Still fits and not worth moving to a smaller class
+        if (size <= old && (c == 0 || size > s_lvmem_class_size[c - 1])) return p;
+    } else if (lvmem_in_heap(p)) {
+        old = multi_heap_get_allocated_size(s_lvmem.heap, p);
+        if (size < LVMEM_PSRAM_MIN && size > s_lvmem_class_size[TB_LVMEM_CLASSES - 1]) {
+            void *n = multi_heap_realloc(s_lvmem.heap, p, size);
+            if (n) {
+                tb_lvmem_class_stats_t *s = &s_lvmem.stats.heap;
+                s->bytes_in_use += multi_heap_get_allocated_size(s_lvmem.heap, n) - old;
+                if (s->bytes_in_use > s->bytes_high_water) s->bytes_high_water = s->bytes_in_use;
+                return n;
+            }
+        }
+    } else {
+        old = heap_caps_get_allocated_size(p);
+    }
+
+    void *n = tb_lv_malloc(size);
+    if (!n) return NULL;
+    memcpy(n, p, (old < size) ? old : size);
+    tb_lv_free(p);
+    return n;
+}
+
+void tb_lvmem_get_stats(tb_lvmem_stats_t *out)
+{
+    *out = s_lvmem.stats;
+    out->heap_frag_pct = 0;
+    if (s_lvmem.heap) {
+        multi_heap_info_t info;
+        multi_heap_get_info(s_lvmem.heap, &info);
+        out->heap_free = info.total_free_bytes;
+        out->heap_largest_free = info.largest_free_block;
+        if (info.total_free_bytes) {
+            out->heap_frag_pct = 100 - 100 * info.largest_free_block / info.total_free_bytes;
+        }
+    }
+}
+
+static void lvmem_log(void)
+{
+    static const char *const names[TB_LVMEM_CLASSES] = { "16", "32", "64", "128", "256" };
+    tb_lvmem_stats_t st;
+    tb_lvmem_get_stats(&st);
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) {
+        const tb_lvmem_class_stats_t *s = &st.cls[c];
+        ESP_LOGI(TAG, "LVMEM %4s B: in use %u/%u, high water %u, allocs %u, spills %u",
+                 names[c], (unsigned)s->in_use, s_lvmem_class_blocks[c], (unsigned)s->high_water,
+                 (unsigned)s->allocs, (unsigned)s->spills);
+    }
+    ESP_LOGI(TAG, "LVMEM TLSF: %u B in use (high water %u), free %u, largest %u, frag %u%%, spills %u",
+             (unsigned)st.heap.bytes_in_use, (unsigned)st.heap.bytes_high_water,
+             (unsigned)st.heap_free, (unsigned)st.heap_largest_free,
+             (unsigned)st.heap_frag_pct, (unsigned)st.heap.spills);
+    ESP_LOGI(TAG, "LVMEM PSRAM: %u B in use (high water %u), %u blocks",
+             (unsigned)st.psram.bytes_in_use, (unsigned)st.psram.bytes_high_water,
+             (unsigned)st.psram.in_use);
+}
+
+#endif // LVMEM_ENABLE
+
+/* ============================================================
+ * Glyph Cache
+ * ============================================================ */
+
+/*
+ * LVGL fetches every glyph bitmap from flash when a label is drawn;
+ * compressed fonts (montserrat) are decompressed each time. The cache
+ * wraps a font: its get_glyph_bitmap returns A8 bitmaps from an atlas of
+ * fixed slots in internal RAM (LRU eviction), its get_glyph_dsc reports
+ * bpp = 8 for every glyph that fits a slot. Larger glyphs and unusual
+ * bpp pass through unchanged. Only used from the LVGL task.
+ */
+/**
+ * Unpack a bit-packed (MSB first, no row padding) bitmap to A8
+ */
+static void glyph_to_a8(const uint8_t *src, uint8_t bpp, uint32_t n, uint8_t *dst)
+{
+    if (bpp == 8) {
+        memcpy(dst, src, n);
+        return;
+    }
+    const uint32_t mask = (1u << bpp) - 1;
+    const uint32_t scale = 255 / mask;      // 1 → 255, 2 → 85, 4 → 17
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t bit = i * bpp;
+        uint32_t v = (src[bit >> 3] >> (8 - bpp - (bit & 7))) & mask;
+        dst[i] = v * scale;
+    }
+}
+
+#if GLYPH_CACHE_ENABLE
+
+typedef struct {
+    lv_font_t        font;      // Must stay first: callbacks get &font
+    const lv_font_t *orig;
+} glyph_font_t;
+
+typedef struct {
+    const lv_font_t *font;      // NULL = free slot
+    uint32_t         letter;
+    uint32_t         last_used;
+} glyph_slot_t;
+
+static struct {
+    glyph_font_t fonts[GLYPH_MAX_FONTS];
+    uint32_t     n_fonts;
+    glyph_slot_t slots[GLYPH_SLOTS];
+    uint8_t     *atlas;         // GLYPH_SLOTS * GLYPH_SLOT_BYTES, internal RAM
+    uint32_t     tick;
+    tb_glyph_cache_stats_t stats;
+} s_glyph;
+
+static inline bool glyph_cacheable(const lv_font_glyph_dsc_t *g)
+{
+    return (g->bpp == 1 || g->bpp == 2 || g->bpp == 4 || g->bpp == 8) &&
+           (uint32_t)g->box_w * g->box_h <= GLYPH_SLOT_BYTES;
+}
+
+static bool glyph_get_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc,
+                          uint32_t letter, uint32_t letter_next)
+{
+    const glyph_font_t *gf = (const glyph_font_t *)font;
+    if (!gf->orig->get_glyph_dsc(font, dsc, letter, letter_next)) return false;
+    if (s_glyph.atlas && glyph_cacheable(dsc)) dsc->bpp = 8;
+    return true;
+}
+
+static const uint8_t *glyph_get_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    const glyph_font_t *gf = (const glyph_font_t *)font;
+    esp_cpu_cycle_count_t t0 = esp_cpu_get_cycle_count();
+    uint32_t tick = ++s_glyph.tick;
+
+    glyph_slot_t *victim = &s_glyph.slots[0];
+    for (int i = 0; i < GLYPH_SLOTS; i++) {
+        glyph_slot_t *s = &s_glyph.slots[i];
+        if (s->font == font && s->letter == letter) {
+            s->last_used = tick;
+            s_glyph.stats.hits++;
+            s_glyph.stats.hit_cycles += esp_cpu_get_cycle_count() - t0;
+            return s_glyph.atlas + i * GLYPH_SLOT_BYTES;
+        }
+        if (!victim->font) continue;
+        if (!s->font || s->last_used < victim->last_used) victim = s;
+    }
+
+    // Miss: fetch (and decompress) the original, then convert into the LRU slot
+    lv_font_glyph_dsc_t dsc;
+    const uint8_t *src = gf->orig->get_glyph_bitmap(font, letter);
+    if (!src || !s_glyph.atlas ||
+        !gf->orig->get_glyph_dsc(font, &dsc, letter, 0) || !glyph_cacheable(&dsc)) {
+        return src;     // Not cached: glyph_get_dsc reported the original bpp
+    }
+    if (victim->font) s_glyph.stats.evictions++;
+    uint8_t *dst = s_glyph.atlas + (victim - s_glyph.slots) * GLYPH_SLOT_BYTES;
+    glyph_to_a8(src, dsc.bpp, (uint32_t)dsc.box_w * dsc.box_h, dst);
+    victim->font = font;
+    victim->letter = letter;
+    victim->last_used = tick;
+
+    s_glyph.stats.misses++;
+    s_glyph.stats.miss_cycles += esp_cpu_get_cycle_count() - t0;
+    return dst;
+}
+
+const lv_font_t *tb_glyph_cache_font(const lv_font_t *font)
+{
+    for (uint32_t i = 0; i < s_glyph.n_fonts; i++) {
+        if (s_glyph.fonts[i].orig == font) return &s_glyph.fonts[i].font;
+    }
+    if (!s_glyph.atlas) {
+        s_glyph.atlas = heap_caps_malloc(GLYPH_SLOTS * GLYPH_SLOT_BYTES,
+                                         MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s_glyph.atlas) ESP_LOGW(TAG, "Glyph cache: no internal RAM, passing through");
+    }
+    if (s_glyph.n_fonts == GLYPH_MAX_FONTS) return font;
+
+    glyph_font_t *gf = &s_glyph.fonts[s_glyph.n_fonts++];
+    gf->font = *font;
+    gf->orig = font;
+    gf->font.get_glyph_dsc = glyph_get_dsc;
+    gf->font.get_glyph_bitmap = glyph_get_bitmap;
+    return &gf->font;
+}
+
+void tb_glyph_cache_get_stats(tb_glyph_cache_stats_t *out)
+{
+    *out = s_glyph.stats;
+}
+
+static void glyph_cache_log(void)
+{
+    const tb_glyph_cache_stats_t *s = &s_glyph.stats;
+    uint32_t total = s->hits + s->misses;
+    if (!total) return;
+    // A hit saves what a miss costs beyond the conversion into the atlas,
+    // so the saving per hit is a lower bound of the original fetch cost
+    uint32_t hit_avg = s->hits ? (uint32_t)(s->hit_cycles / s->hits) : 0;
+    uint32_t miss_avg = s->misses ? (uint32_t)(s->miss_cycles / s->misses) : 0;
+    ESP_LOGI(TAG, "Glyph cache: hit rate %.1f%% (%u/%u), evictions %u, "
+             "%u cyc/hit vs %u cyc/miss, ~%.1f ms saved",
+             100.0f * s->hits / total, (unsigned)s->hits, (unsigned)total, (unsigned)s->evictions,
+             (unsigned)hit_avg, (unsigned)miss_avg,
+             (miss_avg > hit_avg) ? (float)s->hits * (miss_avg - hit_avg) /
+                                    (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000.0f) : 0.0f);
+}
+
+#else
+
+const lv_font_t *tb_glyph_cache_font(const lv_font_t *font)
+{
+    return font;
+}
+
+#endif // GLYPH_CACHE_ENABLE
+
+/* ============================================================
+ * Image Asset Decoder
+ * ============================================================ */
+
+/*
+ * Decodes the "TBI1" blobs written by tools/tb_imgconv.c (see tb_img_hdr_t).
+ * Raw blobs in LVGL's byte order without alpha are handed to LVGL as they
+ * are; everything else is decoded once per image cache entry into PSRAM as
+ * TRUE_COLOR or TRUE_COLOR_ALPHA, so drawing never goes through read_line.
+ */
+#if IMG_DECODER_ENABLE
+
+static struct {
+    const void     *src[IMG_MAX_ASSETS];
+    tb_img_stats_t  stats[IMG_MAX_ASSETS];
+    uint32_t        n;
+} s_img;
+
+static const tb_img_hdr_t *img_blob(const void *src)
+{
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) return NULL;
+    const lv_img_dsc_t *dsc = src;
+    if (dsc->header.cf != LV_IMG_CF_USER_ENCODED_0 || dsc->data_size < sizeof(tb_img_hdr_t)) return NULL;
+
+    const tb_img_hdr_t *h = (const tb_img_hdr_t *)dsc->data;
+    if (h->magic != TB_IMG_MAGIC) return NULL;
+    size_t need = sizeof(*h) + h->color_len + ((h->flags & TB_IMG_F_ALPHA) ? (size_t)h->w * h->h : 0);
+    return (dsc->data_size >= need) ? h : NULL;
+}
+
+static tb_img_stats_t *img_stats_get(const void *src, const tb_img_hdr_t *h)
+{
+    for (uint32_t i = 0; i < s_img.n; i++) {
+        if (s_img.src[i] == src) return &s_img.stats[i];
+    }
+    if (s_img.n == IMG_MAX_ASSETS) return NULL;
+
+    tb_img_stats_t *st = &s_img.stats[s_img.n];
+    s_img.src[s_img.n++] = src;
+    memset(st, 0, sizeof(*st));
+    st->name = h->name;
+    st->flash_bytes = ((const lv_img_dsc_t *)src)->data_size;
+    st->decoded_bytes = (uint32_t)h->w * h->h *
+                        ((h->flags & TB_IMG_F_ALPHA) ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t));
+    return st;
+}
+
+static lv_res_t img_info_cb(lv_img_decoder_t *dec, const void *src, lv_img_header_t *header)
+{
+    (void)dec;
+    const tb_img_hdr_t *h = img_blob(src);
+    if (!h) return LV_RES_INV;
+
+    header->always_zero = 0;
+    header->w = h->w;
+    header->h = h->h;
+    header->cf = (h->flags & TB_IMG_F_ALPHA) ? LV_IMG_CF_TRUE_COLOR_ALPHA : LV_IMG_CF_TRUE_COLOR;
+    return LV_RES_OK;
+}
+
+static lv_res_t img_open_cb(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc)
+{
+    (void)dec;
+    const tb_img_hdr_t *h = img_blob(dsc->src);
+    if (!h) return LV_RES_INV;
+
+    const uint8_t *color = (const uint8_t *)(h + 1);
+    const uint8_t *alpha = color + h->color_len;
+    const uint32_t px = (uint32_t)h->w * h->h;
+    const bool has_alpha = h->flags & TB_IMG_F_ALPHA;
+    const bool swap = (h->flags & TB_IMG_F_SWAP) != (LV_COLOR_16_SWAP ? TB_IMG_F_SWAP : 0);
+    tb_img_stats_t *st = img_stats_get(dsc->src, h);
+
+    if (!has_alpha && !(h->flags & TB_IMG_F_RLE) && !swap) {
+        dsc->img_data = color;
+        if (st) st->decodes++;
+        return LV_RES_OK;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    size_t px_size = has_alpha ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+    uint8_t *out = heap_caps_malloc(px * px_size + 2, MALLOC_CAP_SPIRAM);
+    if (!out) return LV_RES_INV;
+
+    // The 16-bit color plane goes to the (aligned) tail of out; with alpha
+    // it is then spread forward to 3 bytes per pixel, which never overtakes
+    // the pixels still to be read
+    uint16_t *c16 = (uint16_t *)(out + ((px * px_size - px * 2 + 1) & ~1u));
+    if (h->flags & TB_IMG_F_RLE) {
+        if (!rle_decode(color, h->color_len, c16, h->w, h->h, h->w)) {
+            heap_caps_free(out);
+            dsc->error_msg = "corrupt RLE data";
+            return LV_RES_INV;
+        }
+    } else {
+        memcpy(c16, color, px * 2);
+    }
+    if (swap) {
+        for (uint32_t i = 0; i < px; i++) c16[i] = __builtin_bswap16(c16[i]);
+    }
+    if (has_alpha) {
+        for (uint32_t i = 0; i < px; i++) {
+            uint16_t c = c16[i];
+            out[i * 3]     = c & 0xFF;
+            out[i * 3 + 1] = c >> 8;
+            out[i * 3 + 2] = alpha[i];
+        }
+    }
+
+    dsc->img_data = has_alpha ? out : (const uint8_t *)c16;
+    dsc->user_data = out;
+    if (st) {
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        st->decodes++;
+        st->last_decode_us = us;
+        st->total_decode_us += us;
+    }
+    return LV_RES_OK;
+}
+
+static void img_close_cb(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc)
+{
+    (void)dec;
+    heap_caps_free(dsc->user_data);
+    dsc->user_data = NULL;
+}
+
+static void img_decoder_init(void)
+{
+    // Decoders created later are asked first, so this one sees the blobs
+    // before the built-in decoder rejects LV_IMG_CF_USER_ENCODED_0
+    lv_img_decoder_t *dec = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(dec, img_info_cb);
+    lv_img_decoder_set_open_cb(dec, img_open_cb);
+    lv_img_decoder_set_close_cb(dec, img_close_cb);
+}
+
+int tb_img_get_stats(tb_img_stats_t *out, int max)
+{
+    int n = ((int)s_img.n < max) ? (int)s_img.n : max;
+    memcpy(out, s_img.stats, n * sizeof(*out));
+    return n;
+}
+
+static void img_log(void)
+{
+    for (uint32_t i = 0; i < s_img.n; i++) {
+        const tb_img_stats_t *s = &s_img.stats[i];
+        uint32_t avg_us = s->total_decode_us ? s->total_decode_us / s->decodes : 0;
+        ESP_LOGI(TAG, "Image %-16.16s %6u B flash, %6u B decoded (%.0f%%), %u opens, "
+                 "%u us/decode (%.1f MB/s)",
+                 s->name, (unsigned)s->flash_bytes, (unsigned)s->decoded_bytes,
+                 100.0f * s->flash_bytes / s->decoded_bytes, (unsigned)s->decodes, (unsigned)avg_us,
+                 avg_us ? (float)s->decoded_bytes / avg_us : 0.0f);
+    }
+}
+
+#else
+
+int tb_img_get_stats(tb_img_stats_t *out, int max)
+{
+    (void)out;
+    (void)max;
+    return 0;
+}
+
+#endif // IMG_DECODER_ENABLE
+
+/* ============================================================
+ * Decoded-Image Cache
+ * ============================================================ */
+
+/*
+ * A decoder asked before all others that keeps fully decoded pixels in
+ * PSRAM, so PNG / JPEG / RLE images are not decoded again when their
+ * screen is rebuilt. On a miss it opens the real decoder chain (with
+ * itself bypassed) and copies img_data, or gathers the image through
+ * read_line. Images LVGL reads in place (plain lv_img_dsc_t arrays) are
+ * passed through, and so are formats other than TRUE_COLOR(_ALPHA).
+ *
+ * Entries are keyed by source, color and frame; eviction is LRU within
+ * the budget. Entries opened since the last screen change, or pinned
+ * with tb_img_cache_pin(), are never evicted.
+ */
+#if IMGC_ENABLE
+
+typedef struct {
+    const void     *src;            // Variable, or own copy of the path
+    lv_img_src_t    src_type;
+    lv_color_t      color;
+    int32_t         frame_id;
+    lv_img_header_t header;
+    uint8_t        *data;           // NULL = free slot
+    uint32_t        size;
+    uint32_t        last_use;
+    uint32_t        screen_gen;     // Screen generation of the last open
+    uint16_t        refs;           // Open decoder descriptors
+    bool            pinned;
+} imgc_entry_t;
+
+typedef struct {
+    imgc_entry_t        *e;         // Cached, or NULL = passed through
+    lv_img_decoder_dsc_t inner;
+} imgc_open_t;
+
+static struct {
+    imgc_entry_t         entries[IMGC_MAX_ENTRIES];
+    uint32_t             budget;
+    uint32_t             tick;
+    uint32_t             screen_gen;
+    lv_obj_t            *last_scr;
+    bool                 bypass;    // Set while the real decoders run
+    tb_img_cache_stats_t stats;
+} s_imgc;
+
+static bool imgc_key_eq(const imgc_entry_t *e, const void *src, lv_img_src_t type,
+                        lv_color_t color, int32_t frame_id)
+{
+    if (!e->data || e->src_type != type || e->color.full != color.full || e->frame_id != frame_id) {
+        return false;
+    }
+    return (type == LV_IMG_SRC_FILE) ? strcmp(e->src, src) == 0 : e->src == src;
+}
+
+static imgc_entry_t *imgc_find(const void *src, lv_color_t color, int32_t frame_id)
+{
+    lv_img_src_t type = lv_img_src_get_type(src);
+    for (int i = 0; i < IMGC_MAX_ENTRIES; i++) {
+        if (imgc_key_eq(&s_imgc.entries[i], src, type, color, frame_id)) return &s_imgc.entries[i];
+    }
+    return NULL;
+}
+
+static void imgc_free(imgc_entry_t *e)
+{
+    s_imgc.stats.bytes -= e->size;
+    s_imgc.stats.entries--;
+    heap_caps_free(e->data);
+    if (e->src_type == LV_IMG_SRC_FILE) lv_mem_free((void *)e->src);
+    memset(e, 0, sizeof(*e));
+}
+
+static bool imgc_evictable(const imgc_entry_t *e)
+{
+    return e->data && !e->refs && !e->pinned && e->screen_gen != s_imgc.screen_gen;
+}
+
+/**
+ * Evict LRU entries until need bytes and a slot are free, returns the slot
+ */
+static imgc_entry_t *imgc_alloc(uint32_t need)
+{
+    if (need > s_imgc.budget) return NULL;
+    for (;;) {
+        imgc_entry_t *slot = NULL, *victim = NULL;
+        for (int i = 0; i < IMGC_MAX_ENTRIES; i++) {
+            imgc_entry_t *e = &s_imgc.entries[i];
+            if (!e->data) slot = e;
+            else if (imgc_evictable(e) && (!victim || e->last_use < victim->last_use)) victim = e;
+        }
+        if (slot && s_imgc.stats.bytes + need <= s_imgc.budget) return slot;
+        if (!victim) return NULL;
+        imgc_free(victim);
+        s_imgc.stats.evictions++;
+    }
+}
+
+static lv_res_t imgc_info_cb(lv_img_decoder_t *dec, const void *src, lv_img_header_t *header)
+{
+    (void)dec;
+    if (s_imgc.bypass) return LV_RES_INV;
+    if (lv_img_src_get_type(src) == LV_IMG_SRC_SYMBOL) return LV_RES_INV;
+
+    // Any entry of this source has the right header
+    lv_img_src_t type = lv_img_src_get_type(src);
+    for (int i = 0; i < IMGC_MAX_ENTRIES; i++) {
+        const imgc_entry_t *e = &s_imgc.entries[i];
+        if (imgc_key_eq(e, src, type, e->color, e->frame_id)) {
+            *header = e->header;
+            return LV_RES_OK;
+        }
+    }
+    s_imgc.bypass = true;
+    lv_res_t res = lv_img_decoder_get_info(src, header);
+    s_imgc.bypass = false;
+    return res;
+}
+
+/**
+ * Copy the decoded image out of an open inner decoder, NULL if not cacheable
+ */
+static imgc_entry_t *imgc_fill(lv_img_decoder_dsc_t *inner, const void *src)
+{
+    const lv_img_header_t *h = &inner->header;
+    if (h->cf != LV_IMG_CF_TRUE_COLOR && h->cf != LV_IMG_CF_TRUE_COLOR_ALPHA) return NULL;
+
+    // Read in place from the variable: nothing to save
+    lv_img_src_t type = lv_img_src_get_type(src);
+    if (type == LV_IMG_SRC_VARIABLE && inner->img_data) {
+        const lv_img_dsc_t *img = src;
+        if (inner->img_data >= img->data && inner->img_data < img->data + img->data_size) return NULL;
+    }
+
+    const uint32_t px_size = lv_img_cf_get_px_size(h->cf) / 8;
+    const uint32_t size = (uint32_t)h->w * h->h * px_size;
+    imgc_entry_t *e = imgc_alloc(size);
+    if (!e) return NULL;
+    uint8_t *data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!data) return NULL;
+
+    if (inner->img_data) {
+        memcpy(data, inner->img_data, size);
+    } else {
+        for (lv_coord_t y = 0; y < h->h; y++) {
+            if (lv_img_decoder_read_line(inner, 0, y, h->w, data + y * h->w * px_size) != LV_RES_OK) {
+                heap_caps_free(data);
+                return NULL;
+            }
+        }
+    }
+
+    if (type == LV_IMG_SRC_FILE) {
+        char *path = lv_mem_alloc(strlen(src) + 1);
+        if (!path) {
+            heap_caps_free(data);
+            return NULL;
+        }
+        strcpy(path, src);
+        src = path;
+    }
+    e->src = src;
+    e->src_type = type;
+    e->header = *h;
+    e->data = data;
+    e->size = size;
+    s_imgc.stats.bytes += size;
+    s_imgc.stats.entries++;
+    if (s_imgc.stats.bytes > s_imgc.stats.bytes_high_water) s_imgc.stats.bytes_high_water = s_imgc.stats.bytes;
+    return e;
+}
+
+static lv_res_t imgc_open_cb(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc)
+{
+    (void)dec;
+    imgc_open_t *o = lv_mem_alloc(sizeof(imgc_open_t));
+    if (!o) return LV_RES_INV;
+    memset(o, 0, sizeof(*o));
+
+    imgc_entry_t *e = imgc_find(dsc->src, dsc->color, dsc->frame_id);
+    if (e) {
+        s_imgc.stats.hits++;
+    } else {
+        int64_t t0 = esp_timer_get_time();
+        s_imgc.bypass = true;
+        lv_res_t res = lv_img_decoder_open(&o->inner, dsc->src, dsc->color, dsc->frame_id);
+        s_imgc.bypass = false;
+        if (res != LV_RES_OK) {
+            lv_mem_free(o);
+            return LV_RES_INV;
+        }
+        e = imgc_fill(&o->inner, dsc->src);
+        if (e) {
+            e->color = dsc->color;
+            e->frame_id = dsc->frame_id;
+            lv_img_decoder_close(&o->inner);
+            s_imgc.stats.misses++;
+            s_imgc.stats.miss_us += esp_timer_get_time() - t0;
+        } else {
+            s_imgc.stats.passed++;
+        }
+    }
+
+    if (e) {
+        e->refs++;
+        e->last_use = ++s_imgc.tick;
+        e->screen_gen = s_imgc.screen_gen;
+        dsc->header = e->header;
+        dsc->img_data = e->data;
+    } else {
+        dsc->header = o->inner.header;
+        dsc->img_data = o->inner.img_data;
+    }
+    o->e = e;
+    dsc->user_data = o;
+    return LV_RES_OK;
+}
+
+static lv_res_t imgc_read_line_cb(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc,
+                                  lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t *buf)
+{
+    (void)dec;
+    imgc_open_t *o = dsc->user_data;
+    return o->e ? LV_RES_INV : lv_img_decoder_read_line(&o->inner, x, y, len, buf);
+}
+
+static void imgc_close_cb(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc)
+{
+    (void)dec;
+    imgc_open_t *o = dsc->user_data;
+    if (!o) return;
+    if (o->e) o->e->refs--;
+    else lv_img_decoder_close(&o->inner);
+    lv_mem_free(o);
+    dsc->user_data = NULL;
+}
+
+/**
+ * Must run after all other decoders are registered, so it is asked first
+ */
+static void imgc_init(void)
+{
+    size_t spare = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    spare = (spare > IMGC_PSRAM_RESERVE) ? spare - IMGC_PSRAM_RESERVE : 0;
+    s_imgc.budget = s_imgc.stats.budget = (spare < IMGC_BUDGET) ? spare : IMGC_BUDGET;
+
+    lv_img_decoder_t *dec = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(dec, imgc_info_cb);
+    lv_img_decoder_set_open_cb(dec, imgc_open_cb);
+    lv_img_decoder_set_read_line_cb(dec, imgc_read_line_cb);
+    lv_img_decoder_set_close_cb(dec, imgc_close_cb);
+    ESP_LOGI(TAG, "Image cache: %u KB PSRAM budget", (unsigned)(s_imgc.budget / 1024));
+}
+
+/**
+ * Called from the LVGL task: a new screen releases the old screen's pins
+ */
+static void imgc_poll(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+    if (scr == s_imgc.last_scr) return;
+    s_imgc.last_scr = scr;
+    s_imgc.screen_gen++;
+}
+
+void tb_img_cache_pin(const void *src, bool pin)
+{
+    lv_img_src_t type = lv_img_src_get_type(src);
+    for (int i = 0; i < IMGC_MAX_ENTRIES; i++) {
+        imgc_entry_t *e = &s_imgc.entries[i];
+        if (imgc_key_eq(e, src, type, e->color, e->frame_id)) e->pinned = pin;
+    }
+}
+
+void tb_img_cache_get_stats(tb_img_cache_stats_t *out)
+{
+    *out = s_imgc.stats;
+}
+
+static void imgc_log(void)
+{
+    const tb_img_cache_stats_t *s = &s_imgc.stats;
+    uint32_t total = s->hits + s->misses;
+    if (!total) return;
+    ESP_LOGI(TAG, "Image cache: hit rate %.1f%% (%u/%u), %u entries, %u/%u KB (max %u), "
+             "%u evictions, %u passed through, %u us/miss",
+             100.0f * s->hits / total, (unsigned)s->hits, (unsigned)total, (unsigned)s->entries,
+             (unsigned)(s->bytes / 1024), (unsigned)(s->budget / 1024),
+             (unsigned)(s->bytes_high_water / 1024), (unsigned)s->evictions, (unsigned)s->passed,
+             s->misses ? (unsigned)(s->miss_us / s->misses) : 0);
+}
+
+#else
+
+void tb_img_cache_pin(const void *src, bool pin)
+{
+    (void)src;
+    (void)pin;
+}
+
+void tb_img_cache_get_stats(tb_img_cache_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // IMGC_ENABLE
+
+/* ============================================================
+ * Asset Placement
+ * ============================================================ */
+
+/*
+ * Registered images are profiled while LVGL draws them: the draw context's
+ * draw_img_decoded is wrapped and matches the pixel pointer against the
+ * asset data, so only assets read in place are counted (decoded blobs are
+ * read from their PSRAM copy). Bytes read are the clipped area times the
+ * pixel size, a good estimate also for rotated images.
+ *
+ * tb_assets_rebalance() folds the counts into a decaying score and copies
+ * the assets with the most bytes read per byte held into internal RAM,
+ * then PSRAM, within ASSET_*_BUDGET; the rest is read from where it was
+ * registered (usually memory-mapped flash). Scores are kept in NVS
+ * ("assets" namespace), so the first rebalance after boot already knows
+ * the hot assets. It runs on every screen change.
+ */
+#if ASSET_ENABLE
+
+typedef struct {
+    lv_img_dsc_t    *img;
+    const uint8_t   *src_data;      // Data as registered
+    uint8_t         *copy;          // Promoted copy, NULL on TB_ASSET_SOURCE
+    tb_asset_stats_t st;
+    uint64_t         window_bytes;  // Bytes read since the last rebalance
+} asset_t;
+
+static struct {
+    asset_t   assets[ASSET_MAX];
+    uint32_t  n;
+    void    (*draw_img_decoded)(lv_draw_ctx_t *, const lv_draw_img_dsc_t *,
+                                const lv_area_t *, const uint8_t *, lv_img_cf_t);
+    lv_obj_t *last_scr;
+} s_asset;
+
+static void asset_draw_img_decoded(lv_draw_ctx_t *ctx, const lv_draw_img_dsc_t *dsc,
+                                   const lv_area_t *coords, const uint8_t *map_p, lv_img_cf_t cf)
+{
+    asset_t *a = NULL;
+    for (uint32_t i = 0; i < s_asset.n; i++) {
+        const lv_img_dsc_t *img = s_asset.assets[i].img;
+        if (map_p >= img->data && map_p < img->data + img->data_size) {
+            a = &s_asset.assets[i];
+            break;
+        }
+    }
+    if (!a) {
+        s_asset.draw_img_decoded(ctx, dsc, coords, map_p, cf);
+        return;
+    }
+
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    s_asset.draw_img_decoded(ctx, dsc, coords, map_p, cf);
+    a->st.draw_cycles += esp_cpu_get_cycle_count() - t0;
+
+    lv_area_t clip;
+    if (_lv_area_intersect(&clip, coords, ctx->clip_area)) {
+        uint32_t bytes = lv_area_get_size(&clip) * lv_img_cf_get_px_size(cf) / 8;
+        a->st.draws++;
+        a->st.bytes_read += bytes;
+        a->window_bytes += bytes;
+    }
+}
+
+static void asset_nvs_key(const asset_t *a, char key[16])
+{
+    snprintf(key, 16, "%s", a->st.name);   // NVS keys are max. 15 chars
+}
+
+static bool asset_place(asset_t *a, tb_asset_tier_t tier)
+{
+    uint8_t *copy = NULL;
+    if (tier != TB_ASSET_SOURCE) {
+        copy = heap_caps_malloc(a->img->data_size, (tier == TB_ASSET_INTERNAL)
+                                ? (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) : MALLOC_CAP_SPIRAM);
+        if (!copy) return false;
+        memcpy(copy, a->src_data, a->img->data_size);
+    }
+    // Switch the pointer first: the invalidation closes cache entries that
+    // still point into the old copy
+    a->img->data = copy ? copy : a->src_data;
+    lv_img_cache_invalidate_src(a->img);
+    heap_caps_free(a->copy);
+    a->copy = copy;
+    a->st.tier = tier;
+    return true;
+}
+
+esp_err_t tb_asset_register(lv_img_dsc_t *img, const char *name)
+{
+    for (uint32_t i = 0; i < s_asset.n; i++) {
+        if (s_asset.assets[i].img == img) return ESP_OK;
+    }
+    if (s_asset.n == ASSET_MAX) return ESP_ERR_NO_MEM;
+
+    asset_t *a = &s_asset.assets[s_asset.n++];
+    memset(a, 0, sizeof(*a));
+    a->img = img;
+    a->src_data = img->data;
+    a->st.name = name;
+    a->st.size = img->data_size;
+    a->st.tier = TB_ASSET_SOURCE;
+
+    // Score from the last run, if any
+    nvs_handle_t nvs;
+    if (nvs_open("assets", NVS_READONLY, &nvs) == ESP_OK) {
+        char key[16];
+        asset_nvs_key(a, key);
+        nvs_get_u32(nvs, key, &a->st.score);
+        nvs_close(nvs);
+    }
+    return ESP_OK;
+}
+
+void tb_assets_rebalance(void)
+{
+    const uint32_t n = s_asset.n;
+    if (!n) return;
+    int64_t t0 = esp_timer_get_time();
+
+    // Decay: half the old score plus the KB read since the last rebalance
+    uint8_t order[ASSET_MAX];
+    for (uint32_t i = 0; i < n; i++) {
+        asset_t *a = &s_asset.assets[i];
+        a->st.score = a->st.score / 2 + (uint32_t)(a->window_bytes >> 10);
+        a->window_bytes = 0;
+        order[i] = i;
+    }
+
+    // Rank by score per byte held (insertion sort, n is small)
+    for (uint32_t i = 1; i < n; i++) {
+        uint8_t k = order[i];
+        const asset_t *ak = &s_asset.assets[k];
+        uint32_t j = i;
+        while (j > 0) {
+            const asset_t *aj = &s_asset.assets[order[j - 1]];
+            if ((uint64_t)aj->st.score * ak->st.size >= (uint64_t)ak->st.score * aj->st.size) break;
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = k;
+    }
+
+    // Plan greedily within the budgets
+    tb_asset_tier_t target[ASSET_MAX];
+    uint32_t iram = 0, psram = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        const asset_t *a = &s_asset.assets[order[i]];
+        tb_asset_tier_t t = TB_ASSET_SOURCE;
+        if (a->st.score && iram + a->st.size <= ASSET_IRAM_BUDGET) {
+            t = TB_ASSET_INTERNAL;
+            iram += a->st.size;
+        } else if (a->st.score && psram + a->st.size <= ASSET_PSRAM_BUDGET) {
+            t = TB_ASSET_PSRAM;
+            psram += a->st.size;
+        }
+        target[order[i]] = t;
+    }
+
+    // Demote first so the promotions find the memory
+    for (uint32_t i = 0; i < n; i++) {
+        asset_t *a = &s_asset.assets[i];
+        if (a->st.tier != target[i] && a->st.tier != TB_ASSET_SOURCE) asset_place(a, TB_ASSET_SOURCE);
+    }
+    uint32_t moved = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        asset_t *a = &s_asset.assets[i];
+        if (a->st.tier == target[i]) continue;
+        if (asset_place(a, target[i]) ||
+            (target[i] == TB_ASSET_INTERNAL && asset_place(a, TB_ASSET_PSRAM))) {
+            moved++;
+        }
+    }
+
+    nvs_handle_t nvs;
+    tb_flash_op_begin();
+    if (nvs_open("assets", NVS_READWRITE, &nvs) == ESP_OK) {
+        char key[16];
+        for (uint32_t i = 0; i < n; i++) {
+            asset_nvs_key(&s_asset.assets[i], key);
+            nvs_set_u32(nvs, key, s_asset.assets[i].st.score);
+        }
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    tb_flash_op_end();
+
+    ESP_LOGI(TAG, "Assets: %u moved in %u us, %u KB internal, %u KB PSRAM",
+             (unsigned)moved, (unsigned)(esp_timer_get_time() - t0),
+             (unsigned)(iram / 1024), (unsigned)(psram / 1024));
+}
+
+int tb_assets_get_stats(tb_asset_stats_t *out, int max)
+{
+    int n = ((int)s_asset.n < max) ? (int)s_asset.n : max;
+    for (int i = 0; i < n; i++) out[i] = s_asset.assets[i].st;
+    return n;
+}
+
+static void assets_init(lv_draw_ctx_t *ctx)
+{
+    // Without NVS the profile only lives until reset
+    nvs_flash_init();
+    s_asset.draw_img_decoded = ctx->draw_img_decoded;
+    ctx->draw_img_decoded = asset_draw_img_decoded;
+}
+
+/**
+ * Called from the LVGL task: rebalance when a new screen was loaded
+ */
+static void assets_poll(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+    if (scr == s_asset.last_scr) return;
+    s_asset.last_scr = scr;
+    tb_assets_rebalance();
+}
+
+static void assets_log(void)
+{
+    static const char *const tier_name[] = { "source", "PSRAM", "internal" };
+    for (uint32_t i = 0; i < s_asset.n; i++) {
+        const tb_asset_stats_t *s = &s_asset.assets[i].st;
+        if (!s->draws) continue;
+        ESP_LOGI(TAG, "Asset %-15.15s %-8s %6u B, %u draws, %llu KB read, %u cyc/draw, score %u",
+                 s->name, tier_name[s->tier], (unsigned)s->size, (unsigned)s->draws,
+                 (unsigned long long)(s->bytes_read >> 10),
+                 (unsigned)(s->draw_cycles / s->draws), (unsigned)s->score);
+    }
+}
+
+#else
+
+esp_err_t tb_asset_register(lv_img_dsc_t *img, const char *name)
+{
+    (void)img;
+    (void)name;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void tb_assets_rebalance(void)
+{
+}
+
+int tb_assets_get_stats(tb_asset_stats_t *out, int max)
+{
+    (void)out;
+    (void)max;
+    return 0;
+}
+
+#endif // ASSET_ENABLE
+
+/* ============================================================
+ * Numeric Readout Widget
+ * ============================================================ */
+
+/*
+ * Fixed-width text for values that change at 10-20 Hz. The glyphs of
+ * NUMERIC_CHARSET are rendered once per font into A8 sprites of one cell
+ * size; an update compares the old and new text per cell and invalidates
+ * only the cells that changed. Drawing blends the sprites straight into
+ * LVGL's draw buffer (software renderer), no text layout involved.
+ */
+#define NUMERIC_CHARSET     "0123456789+-.: "
+#define NUMERIC_MAX_CELLS   16
+#define NUMERIC_MAX_FONTS   2
+
+typedef struct {
+    const lv_font_t *font;
+    lv_coord_t       cell_w, cell_h;
+    uint8_t         *sprites;   // strlen(NUMERIC_CHARSET) cells of cell_w * cell_h A8
+} numeric_font_t;
+
+typedef struct {
+    const numeric_font_t *nf;
+    lv_color_t            color;
+    uint8_t               n_cells;
+    char                  text[NUMERIC_MAX_CELLS];
+} numeric_t;
+
+static numeric_font_t s_numeric_fonts[NUMERIC_MAX_FONTS];
+
+static const numeric_font_t *numeric_font_get(const lv_font_t *font)
+{
+    numeric_font_t *nf = NULL;
+    for (int i = 0; i < NUMERIC_MAX_FONTS; i++) {
+        if (s_numeric_fonts[i].font == font) return &s_numeric_fonts[i];
+        if (!nf && !s_numeric_fonts[i].font) nf = &s_numeric_fonts[i];
+    }
+    if (!nf) return NULL;
+
+    const int n = sizeof(NUMERIC_CHARSET) - 1;
+    lv_font_glyph_dsc_t g;
+    lv_coord_t cell_w = 0;
+    for (int c = 0; c < n; c++) {
+        if (lv_font_get_glyph_dsc(font, &g, NUMERIC_CHARSET[c], 0) && g.adv_w > cell_w) cell_w = g.adv_w;
+    }
+    lv_coord_t cell_h = lv_font_get_line_height(font);
+    uint8_t *sprites = heap_caps_calloc(n, cell_w * cell_h, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!sprites) return NULL;
+
+    // Render each glyph centered in its cell, on the font's baseline
+    uint8_t a8[GLYPH_SLOT_BYTES * 4];
+    for (int c = 0; c < n; c++) {
+        if (!lv_font_get_glyph_dsc(font, &g, NUMERIC_CHARSET[c], 0) || !g.box_w) continue;
+        const uint8_t *bmp = lv_font_get_glyph_bitmap(g.resolved_font, NUMERIC_CHARSET[c]);
+        if (!bmp || g.bpp > 8 || (uint32_t)g.box_w * g.box_h > sizeof(a8)) continue;
+        glyph_to_a8(bmp, g.bpp, (uint32_t)g.box_w * g.box_h, a8);
+
+        uint8_t *cell = sprites + c * cell_w * cell_h;
+        int x0 = (cell_w - (int)g.adv_w) / 2 + g.ofs_x;
+        int y0 = (cell_h - font->base_line) - g.box_h - g.ofs_y;
+        for (int y = 0; y < g.box_h; y++) {
+            if (y0 + y < 0 || y0 + y >= cell_h) continue;
+            for (int x = 0; x < g.box_w; x++) {
+                if (x0 + x < 0 || x0 + x >= cell_w) continue;
+                cell[(y0 + y) * cell_w + x0 + x] = a8[y * g.box_w + x];
+            }
+        }
+    }
+
+    nf->font = font;
+    nf->cell_w = cell_w;
+    nf->cell_h = cell_h;
+    nf->sprites = sprites;
+    return nf;
+}
+
+static void numeric_cell_area(lv_obj_t *obj, const numeric_t *num, int i, lv_area_t *area)
+{
+    lv_obj_get_coords(obj, area);
+    area->x1 += i * num->nf->cell_w;
+    area->x2 = area->x1 + num->nf->cell_w - 1;
+    area->y2 = area->y1 + num->nf->cell_h - 1;
+}
+
+static void numeric_draw(lv_event_t *e, numeric_t *num)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *ctx = lv_event_get_draw_ctx(e);
+    const numeric_font_t *nf = num->nf;
+    const lv_coord_t buf_w = lv_area_get_width(ctx->buf_area);
+
+    for (int i = 0; i < num->n_cells; i++) {
+        const char *ch = strchr(NUMERIC_CHARSET, num->text[i]);
+        if (!ch || *ch == ' ') continue;
+
+        lv_area_t cell, clip;
+        numeric_cell_area(obj, num, i, &cell);
+        if (!_lv_area_intersect(&clip, &cell, ctx->clip_area)) continue;
+
+        const uint8_t *sprite = nf->sprites + (ch - NUMERIC_CHARSET) * nf->cell_w * nf->cell_h;
+        for (lv_coord_t y = clip.y1; y <= clip.y2; y++) {
+            const uint8_t *src = sprite + (y - cell.y1) * nf->cell_w - cell.x1;
+            lv_color_t *dst = (lv_color_t *)ctx->buf +
+                              (y - ctx->buf_area->y1) * buf_w - ctx->buf_area->x1;
+            for (lv_coord_t x = clip.x1; x <= clip.x2; x++) {
+                uint8_t a = src[x];
+                if (a == LV_OPA_COVER) dst[x] = num->color;
+                else if (a) dst[x] = lv_color_mix(num->color, dst[x], a);
+            }
+        }
+    }
+}
+
+static void numeric_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    numeric_t *num = lv_obj_get_user_data(obj);
+    if (!num) return;
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_DRAW_MAIN:
+        numeric_draw(e, num);
+        break;
+    case LV_EVENT_DELETE:
+        lv_mem_free(num);
+        lv_obj_set_user_data(obj, NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+lv_obj_t *tb_numeric_create(lv_obj_t *parent, const lv_font_t *font, uint8_t n_cells, lv_color_t color)
+{
+    const numeric_font_t *nf = numeric_font_get(font);
+    if (!nf || n_cells == 0 || n_cells > NUMERIC_MAX_CELLS) return NULL;
+
+    numeric_t *num = lv_mem_alloc(sizeof(numeric_t));
+    if (!num) return NULL;
+    num->nf = nf;
+    num->color = color;
+    num->n_cells = n_cells;
+    memset(num->text, ' ', sizeof(num->text));
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(obj, n_cells * nf->cell_w, nf->cell_h);
+    lv_obj_set_user_data(obj, num);
+    lv_obj_add_event_cb(obj, numeric_event_cb, LV_EVENT_ALL, NULL);
+    return obj;
+}
+
+void tb_numeric_set_text(lv_obj_t *obj, const char *txt)
+{
+    numeric_t *num = lv_obj_get_user_data(obj);
+    if (!num) return;
+
+    // Right-aligned, truncated from the left when too long
+    size_t len = strlen(txt);
+    if (len > num->n_cells) {
+        txt += len - num->n_cells;
+        len = num->n_cells;
+    }
+    size_t pad = num->n_cells - len;
+    for (int i = 0; i < num->n_cells; i++) {
+        char c = (i < (int)pad) ? ' ' : txt[i - pad];
+        if (c == num->text[i]) continue;
+        num->text[i] = c;
+        lv_area_t cell;
+        numeric_cell_area(obj, num, i, &cell);
+        lv_obj_invalidate_area(obj, &cell);
+    }
+}
+
+void tb_numeric_set_value(lv_obj_t *obj, int32_t value, uint8_t decimals)
+{
+    char buf[32];
+    if (decimals > 9) decimals = 9;
+    uint32_t div = 1;
+    for (int i = 0; i < decimals; i++) div *= 10;
+    uint32_t a = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;     // INT32_MIN safe
+    if (decimals) {
+        snprintf(buf, sizeof(buf), "%s%u.%0*u", (value < 0) ? "-" : "",
+                 (unsigned)(a / div), (int)decimals, (unsigned)(a % div));
+    } else {
+        snprintf(buf, sizeof(buf), "%d", (int)value);
+    }
+    tb_numeric_set_text(obj, buf);
+}
+
+/* ============================================================
+ * Strip Chart Widget
+ * ============================================================ */
+
+/*
+ * Scrolling plot for live traces. The samples live in a ring buffer per
+ * series; a push only invalidates the columns at the right edge. At the
+ * next render start (stripchart_render_start) the chart's rows in the
+ * Work Buffer are moved left by the accumulated shift, so LVGL renders
+ * just the new columns: the cost per frame is one move plus the new
+ * columns, however many samples arrived. Columns are rasterized row by
+ * row from per-column spans (branch-free inner loop).
+ *
+ * Moving the Work Buffer pixels needs the chart to be opaque and not
+ * covered by other objects, and its area must not be marked deferrable.
+ * Partly off-screen or overflowing the ring, the chart is redrawn whole.
+ */
+#define STRIPCHART_MAX          4       // Charts that shift at the same time
+#define STRIPCHART_MAX_SERIES   4
+#define STRIPCHART_GRID_DIV     4       // Horizontal grid lines
+
+typedef struct {
+    lv_obj_t  *obj;
+    uint8_t    n_series;
+    uint8_t    step;            // Pixels per sample
+    int16_t    min, max;
+    lv_color_t color[STRIPCHART_MAX_SERIES];
+    uint16_t   cap;             // Samples per series in the ring
+    uint16_t   count;           // Valid samples
+    uint16_t   head;            // Next write position
+    uint16_t   pending;         // Samples pushed since the last render start
+    bool       full;            // Whole chart invalidated, nothing to move
+    int16_t    ring[];          // cap x n_series, interleaved by sample
+} stripchart_t;
+
+static stripchart_t *s_charts[STRIPCHART_MAX];
+static int16_t       s_chart_lo[DISP_WIDTH], s_chart_hi[DISP_WIDTH];
+
+/**
+ * Row of sample k (0 = newest) of one series, or INT16_MIN without data
+ */
+static int16_t stripchart_y(const stripchart_t *sc, const lv_area_t *c, uint32_t k, int s)
+{
+    if (k >= sc->count) return INT16_MIN;
+    int16_t v = sc->ring[((sc->head + sc->cap - 1 - k) % sc->cap) * sc->n_series + s];
+    if (v < sc->min) v = sc->min;
+    if (v > sc->max) v = sc->max;
+    const int32_t h = lv_area_get_height(c) - 1;
+    return c->y2 - (int32_t)(v - sc->min) * h / (sc->max - sc->min);
+}
+
+/**
+ * Row at column x (newest sample at the right edge, linear in between)
+ */
+static int16_t stripchart_col_y(const stripchart_t *sc, const lv_area_t *c, lv_coord_t x, int s)
+{
+    const uint32_t d = c->x2 - x;
+    const uint32_t k = d / sc->step, f = d % sc->step;
+    int16_t y0 = stripchart_y(sc, c, k, s);
+    if (y0 == INT16_MIN || f == 0) return y0;
+    int16_t y1 = stripchart_y(sc, c, k + 1, s);
+    if (y1 == INT16_MIN) return INT16_MIN;
+    return y0 + (y1 - y0) * (int32_t)f / sc->step;
+}
+
+static void stripchart_draw(lv_event_t *e, stripchart_t *sc)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *ctx = lv_event_get_draw_ctx(e);
+    lv_area_t c, clip;
+    lv_obj_get_coords(obj, &c);
+    if (!_lv_area_intersect(&clip, &c, ctx->clip_area)) return;
+
+    const lv_coord_t buf_w = lv_area_get_width(ctx->buf_area);
+    const lv_coord_t w = lv_area_get_width(&clip);
+    const lv_color_t bg = lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+    const lv_color_t grid = lv_color_mix(lv_color_white(), bg, LV_OPA_20);
+    const int32_t grid_h = lv_area_get_height(&c) / STRIPCHART_GRID_DIV;
+#define CHART_ROW(y)    ((lv_color_t *)ctx->buf + ((y) - ctx->buf_area->y1) * buf_w + clip.x1 - ctx->buf_area->x1)
+
+    // Background and grid
+    for (lv_coord_t y = clip.y1; y <= clip.y2; y++) {
+        lv_color_t *dst = CHART_ROW(y);
+        const lv_color_t fill = ((y - c.y1) % grid_h == 0) ? grid : bg;
+        for (lv_coord_t x = 0; x < w; x++) dst[x] = fill;
+    }
+
+    // Per series: vertical span per column from its row to the next column's
+    for (int s = 0; s < sc->n_series; s++) {
+        lv_coord_t y_min = LV_COORD_MAX, y_max = LV_COORD_MIN;
+        int16_t next = (clip.x2 < c.x2) ? stripchart_col_y(sc, &c, clip.x2 + 1, s) : INT16_MIN;
+        for (lv_coord_t x = clip.x2; x >= clip.x1; x--) {
+            int16_t y = stripchart_col_y(sc, &c, x, s);
+            int16_t lo = y, hi = y;
+            if (y == INT16_MIN) {
+                lo = 1; hi = 0;                             // Empty span
+            } else if (next != INT16_MIN) {
+                lo = LV_MIN(y, next);
+                hi = LV_MAX(y, next);
+            }
+            s_chart_lo[x - clip.x1] = lo;
+            s_chart_hi[x - clip.x1] = hi;
+            if (lo <= hi) {
+                y_min = LV_MIN(y_min, lo);
+                y_max = LV_MAX(y_max, hi);
+            }
+            next = y;
+        }
+        y_min = LV_MAX(y_min, clip.y1);
+        y_max = LV_MIN(y_max, clip.y2);
+        const lv_color_t col = sc->color[s];
+        for (lv_coord_t y = y_min; y <= y_max; y++) {
+            lv_color_t *dst = CHART_ROW(y);
+            for (lv_coord_t x = 0; x < w; x++) {
+                const bool on = (y >= s_chart_lo[x]) & (y <= s_chart_hi[x]);
+                dst[x].full = on ? col.full : dst[x].full;
+            }
+        }
+    }
+#undef CHART_ROW
+}
+
+/**
+ * Move each shifting chart's pixels in the Work Buffer (render start)
+ */
+static void stripchart_render_start(void)
+{
+    for (int i = 0; i < STRIPCHART_MAX; i++) {
+        stripchart_t *sc = s_charts[i];
+        if (!sc || !sc->pending) continue;
+        const uint32_t shift = sc->pending * sc->step;
+        const bool full = sc->full;
+        sc->pending = 0;
+        sc->full = false;
+        if (full || !lv_obj_is_visible(sc->obj)) continue;
+
+        lv_area_t c;
+        lv_obj_get_coords(sc->obj, &c);
+        const uint32_t keep = lv_area_get_width(&c) - shift;
+        for (lv_coord_t y = c.y1; y <= c.y2; y++) {
+            lv_color_t *row = (lv_color_t *)fb_row(work_buf, y) + c.x1;
+            memmove(row, row + shift, keep * sizeof(lv_color_t));
+        }
+        s_stats.flush_bytes += (uint64_t)keep * lv_area_get_height(&c) * sizeof(lv_color_t);
+        damage_add(&c);     // Moved pixels count as damage (stream, overlays)
+    }
+}
+
+static void stripchart_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    stripchart_t *sc = lv_obj_get_user_data(obj);
+    if (!sc) return;
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_DRAW_MAIN:
+        stripchart_draw(e, sc);
+        break;
+    case LV_EVENT_DELETE:
+        for (int i = 0; i < STRIPCHART_MAX; i++) {
+            if (s_charts[i] == sc) s_charts[i] = NULL;
+        }
+        lv_mem_free(sc);
+        lv_obj_set_user_data(obj, NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+lv_obj_t *tb_stripchart_create(lv_obj_t *parent, lv_coord_t w, lv_coord_t h,
+                               uint8_t n_series, uint8_t px_per_sample)
+{
+    if (!n_series || n_series > STRIPCHART_MAX_SERIES || !px_per_sample ||
+        w <= px_per_sample || w > DISP_WIDTH || h < STRIPCHART_GRID_DIV) {
+        return NULL;
+    }
+    int slot = -1;
+    for (int i = 0; i < STRIPCHART_MAX && slot < 0; i++) {
+        if (!s_charts[i]) slot = i;
+    }
+    if (slot < 0) return NULL;
+
+    const uint16_t cap = w / px_per_sample + 2;
+    stripchart_t *sc = lv_mem_alloc(sizeof(stripchart_t) + cap * n_series * sizeof(int16_t));
+    if (!sc) return NULL;
+    memset(sc, 0, sizeof(*sc));
+    static const int palette[] = { LV_PALETTE_GREEN, LV_PALETTE_CYAN, LV_PALETTE_YELLOW, LV_PALETTE_PINK };
+    for (int s = 0; s < STRIPCHART_MAX_SERIES; s++) sc->color[s] = lv_palette_main(palette[s]);
+    sc->n_series = n_series;
+    sc->step = px_per_sample;
+    sc->min = INT16_MIN / 2;
+    sc->max = INT16_MAX / 2;
+    sc->cap = cap;
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_style_bg_color(obj, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+    lv_obj_set_size(obj, w, h);
+    lv_obj_set_user_data(obj, sc);
+    lv_obj_add_event_cb(obj, stripchart_event_cb, LV_EVENT_ALL, NULL);
+    sc->obj = obj;
+    s_charts[slot] = sc;
+    return obj;
+}
+
+void tb_stripchart_set_series_color(lv_obj_t *obj, uint8_t series, lv_color_t color)
+{
+    stripchart_t *sc = lv_obj_get_user_data(obj);
+    if (!sc || series >= sc->n_series) return;
+    sc->color[series] = color;
+    sc->full = true;
+    lv_obj_invalidate(obj);
+}
+
+void tb_stripchart_set_range(lv_obj_t *obj, int16_t min, int16_t max)
+{
+    stripchart_t *sc = lv_obj_get_user_data(obj);
+    if (!sc || min >= max) return;
+    sc->min = min;
+    sc->max = max;
+    sc->full = true;
+    lv_obj_invalidate(obj);
+}
+
+void tb_stripchart_push(lv_obj_t *obj, const int16_t *values)
+{
+    stripchart_t *sc = lv_obj_get_user_data(obj);
+    if (!sc) return;
+    memcpy(&sc->ring[sc->head * sc->n_series], values, sc->n_series * sizeof(int16_t));
+    sc->head = (sc->head + 1) % sc->cap;
+    if (sc->count < sc->cap) sc->count++;
+    sc->pending++;
+    if (sc->full) return;
+
+    // The new columns plus the one that now connects to them
+    lv_area_t c;
+    lv_obj_get_coords(obj, &c);
+    const int32_t cols = sc->pending * sc->step + 1;
+    if (c.x1 < 0 || c.y1 < 0 || c.x2 >= DISP_WIDTH || c.y2 >= DISP_HEIGHT ||
+        cols >= lv_area_get_width(&c)) {
+        sc->full = true;
+        lv_obj_invalidate(obj);
+        return;
+    }
+    c.x1 = c.x2 - cols + 1;
+    lv_obj_invalidate_area(obj, &c);
+}
+
+/* ============================================================
+ * Damage Scheduling
+ * ============================================================ */
+
+/*
+ * Objects can carry a priority hint (tb_damage_set_priority). Before LVGL
+ * refreshes, damage_sched_filter() classifies the invalidated areas:
+ * critical if it touches a critical object, deferrable if it lies inside
+ * a deferrable one, else normal. The areas are reordered critical →
+ * normal → deferrable, and deferrable ones are dropped from this frame
+ * (removed from inv_areas) as soon as the estimated render + copy time
+ * exceeds DAMAGE_BUDGET_US. Dropped areas are invalidated again after the frame;
+ * after DAMAGE_DEFER_MAX frames an object's area is rendered regardless.
+ * The cost model (ns per rendered pixel, copy time) is measured per frame.
+ *
+ * The filter wraps LVGL's refresh timer and runs before _lv_disp_refr_timer
+ * joins the areas, while inv_areas / inv_p are in the state _lv_inv_area
+ * leaves them. These are private fields of lv_disp_t in LVGL 8.3; other
+ * versions are rejected at build time rather than patched blindly.
+ */
+#if DAMAGE_SCHED_ENABLE
+
+#if LVGL_VERSION_MAJOR != 8 || LVGL_VERSION_MINOR != 3
+#error "DAMAGE_SCHED_ENABLE edits lv_disp_t.inv_areas, only checked against LVGL 8.3"
+#endif
+
+_Static_assert(DAMAGE_MAX_HINTS <= 32, "hint masks are 32 bit");
+
+static struct {
+    struct {
+        lv_obj_t *obj;
+        uint8_t   prio;
+        uint8_t   age;          // Frames its area has been deferred
+    } hint[DAMAGE_MAX_HINTS];
+    uint32_t  n_hints;
+    lv_area_t deferred[LV_INV_BUF_SIZE];    // Invalidated again after the frame
+    uint32_t  n_deferred;
+    float     ns_per_px;        // Render cost, smoothed
+    uint32_t  copy_us;          // Copy + swap, smoothed
+    int64_t   render_start_us;
+    bool      critical;         // Current frame renders critical damage
+    uint64_t  lat_sum;
+    tb_damage_sched_stats_t st;
+} s_sched;
+
+static void damage_sched_delete_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    for (uint32_t i = 0; i < s_sched.n_hints; i++) {
+        if (s_sched.hint[i].obj == obj) {
+            s_sched.hint[i] = s_sched.hint[--s_sched.n_hints];
+            return;
+        }
+    }
+}
+
+esp_err_t tb_damage_set_priority(lv_obj_t *obj, tb_damage_prio_t prio)
+{
+    for (uint32_t i = 0; i < s_sched.n_hints; i++) {
+        if (s_sched.hint[i].obj != obj) continue;
+        if (prio == TB_PRIO_NORMAL) {
+            s_sched.hint[i] = s_sched.hint[--s_sched.n_hints];
+        } else {
+            s_sched.hint[i].prio = prio;
+        }
+        return ESP_OK;
+    }
+    if (prio == TB_PRIO_NORMAL) return ESP_OK;
+    if (s_sched.n_hints == DAMAGE_MAX_HINTS) return ESP_ERR_NO_MEM;
+    s_sched.hint[s_sched.n_hints].obj = obj;
+    s_sched.hint[s_sched.n_hints].prio = prio;
+    s_sched.hint[s_sched.n_hints++].age = 0;
+    lv_obj_add_event_cb(obj, damage_sched_delete_cb, LV_EVENT_DELETE, NULL);
+    return ESP_OK;
+}
+
+/**
+ * Priority of an invalidated area; *hint = deferrable object it lies in
+ */
+static tb_damage_prio_t damage_sched_classify(const lv_area_t *a, int *hint)
+{
+    *hint = -1;
+    for (uint32_t i = 0; i < s_sched.n_hints; i++) {
+        lv_area_t c, tmp;
+        lv_obj_get_coords(s_sched.hint[i].obj, &c);
+        if (s_sched.hint[i].prio == TB_PRIO_CRITICAL) {
+            if (_lv_area_intersect(&tmp, a, &c)) return TB_PRIO_CRITICAL;
+        } else if (*hint < 0 && _lv_area_is_in(a, &c, 0)) {
+            *hint = i;
+        }
+    }
+    return (*hint < 0) ? TB_PRIO_NORMAL : TB_PRIO_DEFERRABLE;
+}
+
+/**
+ * Reorder and thin out the pending areas (refresh timer, before LVGL joins them)
+ */
+static void damage_sched_filter(lv_disp_t *disp)
+{
+    s_sched.critical = false;
+    if (!disp->inv_p) return;
+
+    // Layout first, so hint object coords are current and layout
+    // invalidations are part of the decision
+    lv_obj_update_layout(lv_disp_get_scr_act(disp));
+    lv_obj_update_layout(lv_disp_get_layer_top(disp));
+    lv_obj_update_layout(lv_disp_get_layer_sys(disp));
+
+    // Classify, then order critical → normal → deferrable (stable)
+    lv_area_t area[LV_INV_BUF_SIZE];
+    uint8_t prio[LV_INV_BUF_SIZE];
+    int8_t hint[LV_INV_BUF_SIZE];
+    uint32_t n = 0;
+    for (int i = 0; i < disp->inv_p; i++) {
+        int h;
+        area[n] = disp->inv_areas[i];
+        prio[n] = damage_sched_classify(&area[n], &h);
+        if (h >= 0 && s_sched.hint[h].age >= DAMAGE_DEFER_MAX) {
+            prio[n] = TB_PRIO_NORMAL;       // Waited long enough
+            s_sched.st.forced_areas++;
+        }
+        hint[n++] = h;
+    }
+
+    // Keep deferrable areas only while the estimate fits the budget
+    uint32_t kept = 0, deferred_mask = 0, rendered_mask = 0;
+    float cost_us = s_sched.copy_us;
+    for (int p = TB_PRIO_CRITICAL; p >= TB_PRIO_DEFERRABLE; p--) {
+        for (uint32_t i = 0; i < n; i++) {
+            if (prio[i] != p) continue;
+            float c = lv_area_get_size(&area[i]) * s_sched.ns_per_px / 1000.0f;
+            if (p == TB_PRIO_DEFERRABLE && kept && cost_us + c > DAMAGE_BUDGET_US &&
+                s_sched.n_deferred < LV_INV_BUF_SIZE) {
+                s_sched.deferred[s_sched.n_deferred++] = area[i];
+                deferred_mask |= 1u << hint[i];
+                s_sched.st.deferred_areas++;
+                continue;
+            }
+            if (hint[i] >= 0) rendered_mask |= 1u << hint[i];
+            if (p == TB_PRIO_CRITICAL) s_sched.critical = true;
+            cost_us += c;
+            disp->inv_areas[kept] = area[i];
+            disp->inv_area_joined[kept++] = 0;
+        }
+    }
+    disp->inv_p = kept;
+    for (uint32_t i = 0; i < s_sched.n_hints; i++) {
+        if (rendered_mask & (1u << i)) s_sched.hint[i].age = 0;
+        else if (deferred_mask & (1u << i)) s_sched.hint[i].age++;
+    }
+    if (s_sched.n_deferred) s_sched.st.frames_over++;
+}
+
+static void damage_sched_refr_timer(lv_timer_t *t)
+{
+    damage_sched_filter(t->user_data);
+    _lv_disp_refr_timer(t);
+}
+
+static void damage_sched_init(lv_disp_t *disp)
+{
+    lv_timer_set_cb(_lv_disp_get_refr_timer(disp), damage_sched_refr_timer);
+}
+
+static void damage_sched_render_start(void)
+{
+    s_sched.render_start_us = esp_timer_get_time();
+}
+
+/**
+ * Update the cost model and the critical latency (from render start to
+ * the vsync that shows the frame)
+ */
+static void damage_sched_on_present(int64_t copy_us, int64_t now_us)
+{
+    if (s_damage.pixels) {
+        float ns = (copy_us - s_sched.render_start_us) * 1000.0f / s_damage.pixels;
+        s_sched.ns_per_px += (ns - s_sched.ns_per_px) / 8;
+    }
+    s_sched.copy_us += ((int32_t)(now_us - copy_us) - (int32_t)s_sched.copy_us) / 8;
+
+    if (!s_sched.critical) return;
+    uint32_t lat = (uint32_t)(vsync_next(now_us) - s_sched.render_start_us);
+    s_sched.lat_sum += lat;
+    s_sched.st.critical_frames++;
+    if (lat > s_sched.st.critical_lat_max_us) s_sched.st.critical_lat_max_us = lat;
+}
+
+/**
+ * Invalidate the deferred areas again (LVGL task, after lv_timer_handler)
+ */
+static void damage_sched_poll(void)
+{
+    if (!s_sched.n_deferred) return;
+    lv_disp_t *disp = lv_disp_get_default();
+    for (uint32_t i = 0; i < s_sched.n_deferred; i++) _lv_inv_area(disp, &s_sched.deferred[i]);
+    s_sched.n_deferred = 0;
+}
+
+void tb_damage_sched_get_stats(tb_damage_sched_stats_t *out)
+{
+    *out = s_sched.st;
+    out->critical_lat_avg_us = s_sched.st.critical_frames ?
+                               (uint32_t)(s_sched.lat_sum / s_sched.st.critical_frames) : 0;
+}
+
+static void damage_sched_log(void)
+{
+    tb_damage_sched_stats_t st;
+    tb_damage_sched_get_stats(&st);
+    ESP_LOGI(TAG, "Damage sched: %u frames over budget, %u areas deferred, %u forced, "
+             "critical latency avg %u us max %u us (%u frames), %.1f ns/px, copy %u us",
+             (unsigned)st.frames_over, (unsigned)st.deferred_areas, (unsigned)st.forced_areas,
+             (unsigned)st.critical_lat_avg_us, (unsigned)st.critical_lat_max_us,
+             (unsigned)st.critical_frames, s_sched.ns_per_px, (unsigned)s_sched.copy_us);
+}
+
+#else
+
+esp_err_t tb_damage_set_priority(lv_obj_t *obj, tb_damage_prio_t prio)
+{
+    (void)obj;
+    (void)prio;
+    return ESP_OK;
+}
+
+void tb_damage_sched_get_stats(tb_damage_sched_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // DAMAGE_SCHED_ENABLE
+
+/* ============================================================
+ * LVGL Setup
+ * ============================================================ */
+
+// Kleiner Buffer im schnellen internen SRAM
+// 720 x 40 Zeilen = 57.600 Bytes → passt ins interne RAM
+#define BUF_LINES  40
+static lv_color_t *render_buf = NULL;
+
+/**
+ * LVGL starts rendering a new frame (first strip of the refresh)
+ */
+static void lvgl_render_start_cb(lv_disp_drv_t *drv)
+{
+    TRACE(TRACE_RENDER_BEGIN, 0);
+#if PROF_ENABLE
+    s_prof_frame_start = s_prof_draw_start = PROF_NOW();
+#endif
+    stripchart_render_start();
+#if DAMAGE_SCHED_ENABLE
+    damage_sched_render_start();
+#endif
+}
+
+static void lvgl_display_init(void)
+{
+    lv_init();
+#if IMG_DECODER_ENABLE
+    img_decoder_init();
+#endif
+#if IMGC_ENABLE
+    imgc_init();
+#endif
+
+    // Render-Buffer im schnellen internen RAM!
+    // (Höhe aus der Kalibrierung, falls vorhanden)
+    const uint32_t lines = s_calib.strip_lines ? s_calib.strip_lines : BUF_LINES;
+    render_buf = (lv_color_t *)heap_caps_malloc(
+        DISP_WIDTH * lines * sizeof(lv_color_t), 
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA
+    );
+
+    lv_disp_draw_buf_init(&s_draw_buf,
+                           render_buf,               // Schneller interner Buffer
+                           NULL,
+                           DISP_WIDTH * lines);      // Nicht full-frame!
+
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = DISP_WIDTH;
+    s_disp_drv.ver_res = DISP_HEIGHT;
+    s_disp_drv.flush_cb = lvgl_flush_cb;
+    s_disp_drv.render_start_cb = lvgl_render_start_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    
+    // KEIN direct_mode → LVGL rendert in den kleinen internen Buffer
+    s_disp_drv.direct_mode = 0;
+    s_disp_drv.full_refresh = 0;
+
+    lv_disp_drv_register(&s_disp_drv);
+#if DAMAGE_SCHED_ENABLE
+    damage_sched_init(lv_disp_get_default());
+#endif
+#if ASSET_ENABLE
+    assets_init(s_disp_drv.draw_ctx);
+#endif
+}
+
+/* ============================================================
+ * Touch Input
+ * ============================================================ */
+
+/*
+ * The controller's INT line wakes touch_task on core 0, which reads the
+ * point over I2C and queues it with the interrupt timestamp. The queue is
+ * single-producer (touch_task) / single-consumer (LVGL task) and lock-free.
+ * A new event also wakes the LVGL task and makes its indev read due, so
+ * input waits neither for the lvgl_task delay nor for the indev period,
+ * and I2C never runs on the render core.
+ *
+ * While pressed, touch_read_cb hands LVGL the position extrapolated to the
+ * vsync that will show the frame rendered now: the present latency is
+ * tracked per frame (touch_on_present), the velocity from the last two
+ * samples. tb_touch_replay() swaps the controller for a recorded gesture,
+ * fed through the same path by a timer instead of the interrupt.
+ */
+#if TOUCH_ENABLE
+
+#define TOUCH_HW    (TOUCH_INT_GPIO >= 0 && TOUCH_I2C_SDA >= 0 && TOUCH_I2C_SCL >= 0)
+
+typedef struct {
+    int64_t t_us;               // Interrupt (or replay timer) time
+    int16_t x, y;
+    bool    pressed;
+} touch_evt_t;
+
+static struct {
+    touch_evt_t       q[TOUCH_QUEUE_LEN];
+    uint32_t          head;         // Written by touch_task only
+    uint32_t          tail;         // Written by the LVGL task only
+    volatile int64_t  irq_us;
+    TaskHandle_t      task;
+    TaskHandle_t      lvgl_task;    // Woken on new events
+    i2c_master_dev_handle_t dev;
+    lv_indev_drv_t    drv;
+    lv_indev_t       *indev;
+
+    // Replay stand-in controller
+    esp_timer_handle_t       replay_timer;
+    const tb_touch_sample_t *replay;
+    size_t                   replay_n, replay_pos;
+    bool                     replay_loop;
+    tb_touch_sample_t        replay_cur;    // Sample "read" on the next wake (s_touch_lock)
+    tb_touch_sample_t       *rec;           // tb_touch_record() target ...
+    size_t                   rec_cap, rec_n;
+    int64_t                  rec_t0;        // ... all under s_touch_lock
+
+    // LVGL task side
+    touch_evt_t cur, prev;
+    float       vx, vy;             // px/us
+    int64_t     read_us;            // Last read that consumed events ...
+    int64_t     lat_from_us;        // ... and the oldest of them
+    uint32_t    present_us;         // Smoothed read → present latency
+
+    tb_touch_stats_t st;
+    uint64_t    lat_sum, pred_sum;
+    uint32_t    lat_n, pred_n;
+} s_touch;
+
+static portMUX_TYPE s_touch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void touch_push(const touch_evt_t *e)
+{
+    uint32_t h = s_touch.head;
+    if (h - __atomic_load_n(&s_touch.tail, __ATOMIC_ACQUIRE) == TOUCH_QUEUE_LEN) {
+        s_touch.st.dropped++;
+        return;
+    }
+    s_touch.q[h % TOUCH_QUEUE_LEN] = *e;
+    __atomic_store_n(&s_touch.head, h + 1, __ATOMIC_RELEASE);
+    s_touch.st.events++;
+}
+
+static bool touch_pop(touch_evt_t *e)
+{
+    uint32_t t = s_touch.tail;
+    if (t == __atomic_load_n(&s_touch.head, __ATOMIC_ACQUIRE)) return false;
+    *e = s_touch.q[t % TOUCH_QUEUE_LEN];
+    __atomic_store_n(&s_touch.tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#if TOUCH_HW
+static IRAM_ATTR void touch_isr(void *arg)
+{
+    s_touch.irq_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_touch.task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+#endif
+
+/**
+ * FT5x06 / FT6x36: TD_STATUS and the first point from register 0x02
+ */
+static esp_err_t touch_ft5x06_read(touch_evt_t *e)
+{
+    static const uint8_t reg = 0x02;
+    uint8_t b[5];
+    esp_err_t err = i2c_master_transmit_receive(s_touch.dev, &reg, 1, b, sizeof(b), 10);
+    if (err != ESP_OK) return err;
+    // Event flag in P1_XH[7:6]: 1 = lift up
+    e->pressed = (b[0] & 0x0F) && (b[1] >> 6) != 1;
+    if (e->pressed) {
+        e->x = ((b[1] & 0x0F) << 8) | b[2];
+        e->y = ((b[3] & 0x0F) << 8) | b[4];
+    }
+    return ESP_OK;
+}
+
+static void touch_task(void *arg)
+{
+    touch_evt_t last = { 0 };
+    while (1) {
+        // While pressed also wake without an interrupt: a lost lift edge
+        // must not leave LVGL with a stuck press
+        uint32_t irq = ulTaskNotifyTake(pdTRUE, last.pressed ? pdMS_TO_TICKS(TOUCH_RELEASE_MS)
+                                                             : portMAX_DELAY);
+        touch_evt_t e = last;
+        e.t_us = irq ? s_touch.irq_us : esp_timer_get_time();
+        if (s_touch.replay) {
+            // The replay timer writes it from another task: copy it whole
+            portENTER_CRITICAL(&s_touch_lock);
+            const tb_touch_sample_t r = s_touch.replay_cur;
+            portEXIT_CRITICAL(&s_touch_lock);
+            e.x = r.x;
+            e.y = r.y;
+            e.pressed = r.pressed;
+        } else if (!s_touch.dev) {
+            continue;
+        } else if (touch_ft5x06_read(&e) != ESP_OK) {
+            s_touch.st.read_errors++;
+            continue;
+        }
+        if (!e.pressed && !last.pressed) continue;  // Nothing new
+        last = e;
+        touch_push(&e);
+        portENTER_CRITICAL(&s_touch_lock);
+        if (s_touch.rec && s_touch.rec_n < s_touch.rec_cap) {
+            if (!s_touch.rec_n) s_touch.rec_t0 = e.t_us;
+            s_touch.rec[s_touch.rec_n++] = (tb_touch_sample_t){
+                .t_ms = (uint32_t)((e.t_us - s_touch.rec_t0) / 1000), .x = e.x, .y = e.y, .pressed = e.pressed,
+            };
+        }
+        portEXIT_CRITICAL(&s_touch_lock);
+        if (s_touch.lvgl_task) xTaskNotifyGive(s_touch.lvgl_task);
+    }
+}
+
+/**
+ * Replay timer: "interrupt" for the current sample, then arm the next one
+ */
+static void touch_replay_timer_cb(void *arg)
+{
+    const tb_touch_sample_t *r = s_touch.replay;
+    if (!r) return;
+    size_t pos = s_touch.replay_pos;
+    portENTER_CRITICAL(&s_touch_lock);
+    s_touch.replay_cur = r[pos];
+    portEXIT_CRITICAL(&s_touch_lock);
+    s_touch.irq_us = esp_timer_get_time();
+    xTaskNotifyGive(s_touch.task);
+
+    size_t next = pos + 1;
+    uint32_t delay_ms;
+    if (next < s_touch.replay_n) {
+        delay_ms = r[next].t_ms - r[pos].t_ms;
+    } else if (s_touch.replay_loop) {
+        next = 0;
+        delay_ms = r[0].t_ms;       // Pause before the next round
+    } else {
+        return;                     // Keeps reporting the last sample
+    }
+    s_touch.replay_pos = next;
+    esp_timer_start_once(s_touch.replay_timer, delay_ms * 1000ULL);
+}
+
+esp_err_t tb_touch_replay(const tb_touch_sample_t *samples, size_t n, bool loop)
+{
+    if (!s_touch.task) return ESP_ERR_INVALID_STATE;
+    if (!s_touch.replay_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = touch_replay_timer_cb,
+            .name = "touch_replay",
+        };
+        ESP_RETURN_ON_ERROR(esp_timer_create(&args, &s_touch.replay_timer), TAG, "replay timer");
+    }
+    esp_timer_stop(s_touch.replay_timer);
+    s_touch.replay = NULL;
+    if (!samples || !n) return ESP_OK;
+
+    s_touch.replay_n = n;
+    s_touch.replay_pos = 0;
+    s_touch.replay_loop = loop;
+    s_touch.replay = samples;
+    return esp_timer_start_once(s_touch.replay_timer, samples[0].t_ms * 1000ULL);
+}
+
+size_t tb_touch_record(tb_touch_sample_t *buf, size_t cap)
+{
+    // touch_task appends on the other core: swap buffer and count together
+    portENTER_CRITICAL(&s_touch_lock);
+    size_t n = s_touch.rec_n;
+    s_touch.rec_n = 0;
+    s_touch.rec_cap = cap;
+    s_touch.rec = buf;
+    portEXIT_CRITICAL(&s_touch_lock);
+    return n;
+}
+
+/**
+ * Track a consumed event: velocity from the last two pressed samples
+ */
+static void touch_track(const touch_evt_t *e)
+{
+    if (e->pressed && s_touch.cur.pressed) {
+        int64_t dt = e->t_us - s_touch.cur.t_us;
+        if (dt > 0 && dt < TOUCH_PREDICT_GAP_US) {
+            // Average with the previous estimate against controller jitter
+            s_touch.vx = 0.5f * (s_touch.vx + (float)(e->x - s_touch.cur.x) / dt);
+            s_touch.vy = 0.5f * (s_touch.vy + (float)(e->y - s_touch.cur.y) / dt);
+        } else {
+            s_touch.vx = s_touch.vy = 0;
+        }
+    } else {
+        s_touch.vx = s_touch.vy = 0;
+    }
+    s_touch.prev = s_touch.cur;
+    s_touch.cur = *e;
+}
+
+static lv_coord_t touch_clamp(float v, int max)
+{
+    return (v < 0) ? 0 : (v > max - 1) ? max - 1 : (lv_coord_t)v;
+}
+
+static void touch_read_cb(lv_indev_drv_t *drv, lv_indev_data_t *data)
+{
+    // Consume up to the next press / release change so no click is lost
+    touch_evt_t e;
+    bool changed = false, any = false;
+    while (!changed && touch_pop(&e)) {
+        changed = (e.pressed != s_touch.cur.pressed);
+        if (!any && !s_touch.lat_from_us) s_touch.lat_from_us = e.t_us;
+        any = true;
+        touch_track(&e);
+    }
+    int64_t now = esp_timer_get_time();
+    if (any) s_touch.read_us = now;
+    data->continue_reading = changed && s_touch.tail != __atomic_load_n(&s_touch.head, __ATOMIC_ACQUIRE);
+
+    const touch_evt_t *c = &s_touch.cur;
+    data->state = c->pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->point.x = c->x;
+    data->point.y = c->y;
+    if (!c->pressed || (s_touch.vx == 0 && s_touch.vy == 0)) return;
+
+    // Extrapolate to the vsync that shows the frame rendered from this read
+    int64_t dt = vsync_next(now + s_touch.present_us) - c->t_us;
+    if (dt > TOUCH_PREDICT_MAX_US) dt = TOUCH_PREDICT_MAX_US;
+    data->point.x = touch_clamp(c->x + s_touch.vx * dt, DISP_WIDTH);
+    data->point.y = touch_clamp(c->y + s_touch.vy * dt, DISP_HEIGHT);
+    s_touch.pred_sum += abs(data->point.x - c->x) + abs(data->point.y - c->y);
+    s_touch.pred_n++;
+}
+
+/**
+ * Frame presented: latency from the interrupt to the vsync that shows it
+ */
+static void touch_on_present(int64_t now_us)
+{
+    if (!s_touch.lat_from_us) return;
+    uint32_t lat = (uint32_t)(vsync_next(now_us) - s_touch.lat_from_us);
+    s_touch.lat_sum += lat;
+    s_touch.lat_n++;
+    if (lat > s_touch.st.latency_max_us) s_touch.st.latency_max_us = lat;
+    int32_t present = (int32_t)(now_us - s_touch.read_us);
+    s_touch.present_us += (present - (int32_t)s_touch.present_us) / 8;
+    s_touch.lat_from_us = 0;
+}
+
+/**
+ * Make the indev read due when events are queued (LVGL task, before
+ * lv_timer_handler)
+ */
+static void touch_poll(void)
+{
+    if (s_touch.indev && s_touch.tail != __atomic_load_n(&s_touch.head, __ATOMIC_ACQUIRE)) {
+        lv_timer_ready(s_touch.indev->driver->read_timer);
+    }
+}
+
+void tb_touch_get_stats(tb_touch_stats_t *out)
+{
+    *out = s_touch.st;
+    out->latency_avg_us = s_touch.lat_n ? (uint32_t)(s_touch.lat_sum / s_touch.lat_n) : 0;
+    out->predict_avg_px = s_touch.pred_n ? (uint16_t)(s_touch.pred_sum / s_touch.pred_n) : 0;
+}
+
+static void touch_log(void)
+{
+    tb_touch_stats_t st;
+    tb_touch_get_stats(&st);
+    ESP_LOGI(TAG, "Touch: %u events, %u dropped, %u I2C errors, latency avg %u us max %u us, "
+             "prediction avg %u px",
+             (unsigned)st.events, (unsigned)st.dropped, (unsigned)st.read_errors,
+             (unsigned)st.latency_avg_us, (unsigned)st.latency_max_us, st.predict_avg_px);
+}
+
+static void touch_init(void)
+{
+    lv_indev_drv_init(&s_touch.drv);
+    s_touch.drv.type = LV_INDEV_TYPE_POINTER;
+    s_touch.drv.read_cb = touch_read_cb;
+    s_touch.indev = lv_indev_drv_register(&s_touch.drv);
+    xTaskCreatePinnedToCore(touch_task, "touch", 3072, NULL, 6, &s_touch.task, 0);
+
+#if !TOUCH_HW
+    ESP_LOGW(TAG, "Touch: no pins configured, replay only");
+#else
+    i2c_master_bus_handle_t bus;
+    const i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = -1,
+        .sda_io_num = TOUCH_I2C_SDA,
+        .scl_io_num = TOUCH_I2C_SCL,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = 1,
+    };
+    const i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = TOUCH_I2C_ADDR,
+        .scl_speed_hz = 400000,
+    };
+    const gpio_config_t int_cfg = {
+        .pin_bit_mask = 1ULL << TOUCH_INT_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    esp_err_t err = i2c_new_master_bus(&bus_cfg, &bus);
+    if (err == ESP_OK) err = i2c_master_bus_add_device(bus, &dev_cfg, &s_touch.dev);
+    if (err == ESP_OK) err = gpio_config(&int_cfg);
+    if (err == ESP_OK) {
+        err = gpio_install_isr_service(0);
+        if (err == ESP_ERR_INVALID_STATE) err = ESP_OK;     // Already installed
+    }
+    if (err == ESP_OK) err = gpio_isr_handler_add(TOUCH_INT_GPIO, touch_isr, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Touch init failed (0x%x), replay only", err);
+        s_touch.dev = NULL;
+    }
+#endif
+}
+
+#else
+
+esp_err_t tb_touch_replay(const tb_touch_sample_t *samples, size_t n, bool loop)
+{
+    (void)samples;
+    (void)n;
+    (void)loop;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+size_t tb_touch_record(tb_touch_sample_t *buf, size_t cap)
+{
+    (void)buf;
+    (void)cap;
+    return 0;
+}
+
+void tb_touch_get_stats(tb_touch_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // TOUCH_ENABLE
+
+/* ============================================================
+ * Boot Calibration
+ * ============================================================ */
+
+/*
+ * The copy crossover, render strip height and bounce size depend on the
+ * PSRAM chip, its clock and the flash layout of the board. With
+ * CALIB_ENABLE the first boot measures them in three steps and stores the
+ * result in NVS ("calib"); later boots only load it. The record is keyed
+ * by CALIB_VERSION and a CRC of the build settings it depends on, so a
+ * different PSRAM clock or scanout mode recalibrates by itself.
+ *
+ *   calib_measure_copy     before the panel: CPU write and GDMA copy rate,
+ *                          CPU/GDMA crossover by doubling sizes
+ *   calib_measure_scanout  panel running: GDMA rate during scanout, and
+ *                          the spread of 64 KB copies as the PSRAM stall
+ *                          the bounce buffers must bridge
+ *   calib_measure_strips   UI created: full-screen refresh per strip
+ *                          height, giving the overhead per strip
+ *
+ * The crossover and strip height apply at once, the bounce size (planned
+ * in lcd_panel_init) from the next boot on. tb_recalibrate() forces a rerun.
+ */
+#if CALIB_ENABLE
+
+typedef struct {
+    uint32_t   version;         // CALIB_VERSION
+    uint32_t   config;          // calib_config() at the time of measuring
+    tb_calib_t c;
+} calib_record_t;
+
+static bool s_calib_valid = false;
+
+/**
+ * CRC over the build settings the measurements depend on
+ */
+static uint32_t calib_config(void)
+{
+    const uint32_t cfg[] = {
+        PSRAM_CLK_MHZ, PSRAM_BITS_PER_CLK, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        PANEL_TARGET_HZ, SCANOUT_BOUNCE, HYBRID_FB_ENABLE, FB_SIZE,
+    };
+    return esp_rom_crc32_le(0, (const uint8_t *)cfg, sizeof(cfg));
+}
+
+static bool calib_load(void)
+{
+    nvs_flash_init();
+    calib_record_t rec;
+    size_t len = sizeof(rec);
+    nvs_handle_t nvs;
+    if (nvs_open("calib", NVS_READONLY, &nvs) != ESP_OK) return false;
+    bool ok = nvs_get_blob(nvs, "params", &rec, &len) == ESP_OK && len == sizeof(rec) &&
+              rec.version == CALIB_VERSION && rec.config == calib_config();
+    nvs_close(nvs);
+    if (ok) {
+        s_calib = rec.c;
+        s_calib_valid = true;
+    }
+    return ok;
+}
+
+static void calib_save(void)
+{
+    const calib_record_t rec = { .version = CALIB_VERSION, .config = calib_config(), .c = s_calib };
+    nvs_handle_t nvs;
+    tb_flash_op_begin();
+    if (nvs_open("calib", NVS_READWRITE, &nvs) == ESP_OK) {
+        s_calib_valid = nvs_set_blob(nvs, "params", &rec, sizeof(rec)) == ESP_OK &&
+                        nvs_commit(nvs) == ESP_OK;
+        nvs_close(nvs);
+    }
+    tb_flash_op_end();
+}
+
+static uint32_t calib_rate(size_t bytes, int64_t us)
+{
+    return (us > 0) ? (uint32_t)(bytes * 1000000ULL / us) : 0;
+}
+
+static int64_t calib_time_gdma(size_t len)
+{
+    int64_t best = INT64_MAX;
+    for (int r = 0; r < CALIB_RUNS; r++) {
+        int64_t t0 = esp_timer_get_time();
+        gdma_copy_buffer(back_buf, work_buf, len);
+        int64_t dt = esp_timer_get_time() - t0;
+        if (dt < best) best = dt;
+    }
+    return best;
+}
+
+/**
+ * CPU and GDMA rates without scanout, and the size from which GDMA wins.
+ * Uses Work and Back Buffer, which hold nothing yet.
+ */
+static void calib_measure_copy(void)
+{
+    // CPU writes incl. write-back, so the bytes really reach PSRAM
+    int64_t best = INT64_MAX;
+    for (int r = 0; r < CALIB_RUNS; r++) {
+        int64_t t0 = esp_timer_get_time();
+        memset(work_buf, r, FB_SIZE);
+        esp_cache_msync(work_buf, FB_SIZE, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+        int64_t dt = esp_timer_get_time() - t0;
+        if (dt < best) best = dt;
+    }
+    s_calib.cpu_write_bw = calib_rate(FB_SIZE, best);
+    s_calib.gdma_bw = calib_rate(FB_SIZE, calib_time_gdma(FB_SIZE));
+
+    // s_calib.copy_crossover is still 0: gdma_copy_buffer always uses GDMA
+    size_t len;
+    for (len = 256; len < CALIB_COPY_MAX; len *= 2) {
+        int64_t cpu = INT64_MAX;
+        for (int r = 0; r < CALIB_RUNS; r++) {
+            int64_t t0 = esp_timer_get_time();
+            memcpy(back_buf, work_buf, len);
+            esp_cache_msync(back_buf, len, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+            int64_t dt = esp_timer_get_time() - t0;
+            if (dt < cpu) cpu = dt;
+        }
+        if (calib_time_gdma(len) <= cpu) break;
+    }
+    s_calib.copy_crossover = len;
+}
+
+/**
+ * GDMA rate while LCD_CAM scans out, and the spread of 64 KB copies
+ */
+static void calib_measure_scanout(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(50));      // Scanout running for a few frames
+    s_calib.gdma_scan_bw = calib_rate(FB_SIZE, calib_time_gdma(FB_SIZE));
+
+    // A percentile, not the maximum: one preemption must not size the
+    // bounce buffers for good
+    enum { N = 8 * CALIB_RUNS };
+    int64_t dt[N];
+    for (int r = 0; r < N; r++) {
+        int64_t t0 = esp_timer_get_time();
+        gdma_copy_buffer(back_buf, work_buf, 64 * 1024);
+        int64_t v = esp_timer_get_time() - t0;
+        int i = r;
+        for (; i > 0 && dt[i - 1] > v; i--) dt[i] = dt[i - 1];
+        dt[i] = v;
+    }
+    s_calib.stall_us = (uint32_t)(dt[N * CALIB_STALL_PCT / 100] - dt[0]);
+    s_calib.bounce_lines = plan_bounce_lines(&s_plan, s_calib.stall_us);
+}
+
+/**
+ * Refresh the whole screen at each strip height that fits the internal
+ * RAM and keep the smallest one within CALIB_STRIP_TOL_PCT of the fastest
+ */
+static void calib_measure_strips(void)
+{
+    enum { N = (CALIB_STRIP_MAX - CALIB_STRIP_MIN) / CALIB_STRIP_STEP + 1 };
+    const size_t row = DISP_WIDTH * sizeof(lv_color_t);
+
+    heap_caps_free(render_buf);
+    size_t avail = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    uint32_t max = (avail > CALIB_RAM_RESERVE) ? (avail - CALIB_RAM_RESERVE) / row : 0;
+    if (max > CALIB_STRIP_MAX) max = CALIB_STRIP_MAX;
+    lv_color_t *buf = (max >= CALIB_STRIP_MIN) ?
+                      heap_caps_malloc(max * row, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA) : NULL;
+    if (!buf) {
+        // No room to try: keep the default height
+        max = 0;
+        buf = heap_caps_malloc(BUF_LINES * row, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    }
+    lv_disp_t *disp = lv_disp_get_default();
+
+    int64_t t[N];
+    uint32_t n = 0, best = 0;
+    for (uint32_t h = CALIB_STRIP_MIN; h <= max; h += CALIB_STRIP_STEP, n++) {
+        lv_disp_draw_buf_init(&s_draw_buf, buf, NULL, DISP_WIDTH * h);
+        t[n] = INT64_MAX;
+        for (int r = 0; r < CALIB_RUNS; r++) {
+            lv_obj_invalidate(lv_scr_act());
+            int64_t t0 = esp_timer_get_time();
+            lv_refr_now(disp);
+            int64_t dt = esp_timer_get_time() - t0;
+            if (dt < t[n]) t[n] = dt;
+        }
+        if (t[n] < t[best]) best = n;
+    }
+
+    uint32_t pick = best;
+    if (n) {
+        while (pick > 0 && t[pick - 1] * 100 <= t[best] * (100 + CALIB_STRIP_TOL_PCT)) pick--;
+        // Frame time = fixed + strips x overhead: slope between the extremes
+        const uint32_t s0 = (DISP_HEIGHT + CALIB_STRIP_MIN - 1) / CALIB_STRIP_MIN;
+        const uint32_t h1 = CALIB_STRIP_MIN + (n - 1) * CALIB_STRIP_STEP;
+        const uint32_t s1 = (DISP_HEIGHT + h1 - 1) / h1;
+        s_calib.strip_us = (s0 > s1) ? (uint32_t)((t[0] - t[n - 1]) / (s0 - s1)) : 0;
+        s_calib.strip_lines = CALIB_STRIP_MIN + pick * CALIB_STRIP_STEP;
+    } else {
+        s_calib.strip_lines = BUF_LINES;
+    }
+
+    // Shrink in place to the chosen height (a failed shrink keeps buf,
+    // which is at least that large)
+    render_buf = heap_caps_realloc(buf, s_calib.strip_lines * row, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    if (!render_buf) render_buf = buf;
+    lv_disp_draw_buf_init(&s_draw_buf, render_buf, NULL, DISP_WIDTH * s_calib.strip_lines);
+}
+
+static void calib_log(void)
+{
+    ESP_LOGI(TAG, "Calibration%s: CPU write %.1f MB/s, GDMA %.1f MB/s (%.1f during scanout), "
+             "stall %u us",
+             s_calib_valid ? "" : " (not stored)", s_calib.cpu_write_bw / 1e6f,
+             s_calib.gdma_bw / 1e6f, s_calib.gdma_scan_bw / 1e6f, (unsigned)s_calib.stall_us);
+    ESP_LOGI(TAG, "Calibration: CPU copies below %u B, %u-line strips (%u us per strip), "
+             "%u bounce lines",
+             (unsigned)s_calib.copy_crossover, s_calib.strip_lines, (unsigned)s_calib.strip_us,
+             s_calib.bounce_lines);
+    if (s_plan.bounce_lines && s_plan.bounce_lines != s_calib.bounce_lines) {
+        ESP_LOGI(TAG, "Calibration: bounce size applies after restart");
+    }
+}
+
+const tb_calib_t *tb_get_calibration(void)
+{
+    return s_calib_valid ? &s_calib : NULL;
+}
+
+void tb_recalibrate(void)
+{
+    nvs_handle_t nvs;
+    tb_flash_op_begin();
+    if (nvs_open("calib", NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, "params");
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    tb_flash_op_end();
+    esp_restart();
+}
 
-    ESP_RETURN_ON_ERROR(esp_lcd_new_rgb_panel(&panel_config, &s_panel_handle),
-                        TAG, "RGB panel creation failed");
-    ESP_RETURN_ON_ERROR(esp_lcd_panel_reset(s_panel_handle), TAG, "Panel reset failed");
-    ESP_RETURN_ON_ERROR(esp_lcd_panel_init(s_panel_handle), TAG, "Panel init failed");
+#else
 
-    return ESP_OK;
+const tb_calib_t *tb_get_calibration(void)
+{
+    return NULL;
+}
+
+void tb_recalibrate(void)
+{
 }
 
+#endif // CALIB_ENABLE
+
 /* ============================================================
- * LVGL Setup
+ * Bandwidth / Utilization Accounting
  * ============================================================ */
 
-// Kleiner Buffer im schnellen internen SRAM
-// 720 x 40 Zeilen = 57.600 Bytes → passt ins interne RAM
-#define BUF_LINES  40
-static lv_color_t *render_buf = NULL;
+/*
+ * Cumulative counters (s_stats, s_vsync_count, idle time) are turned into
+ * per-second numbers by usage_update(), which runs in the LVGL task that
+ * owns s_stats. The result is published under a spinlock for tb_get_usage().
+ *
+ * Idle time: the run-time counters of the per-core FreeRTOS idle tasks
+ * (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS), in ticks of the configured
+ * run-time clock: esp_timer (1 MHz) or the CPU clock. The idle tasks keep
+ * entering WAITI; nothing hooks into their loop. Without run-time stats
+ * core_busy_pct stays 0.
+ */
+#if defined(CONFIG_FREERTOS_RUN_TIME_COUNTER_CLK_CPU_CLK) || defined(CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK)
+#define USAGE_IDLE_TICKS_PER_US CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#else
+#define USAGE_IDLE_TICKS_PER_US 1
+#endif
 
-static void lvgl_display_init(void)
+static portMUX_TYPE s_usage_lock = portMUX_INITIALIZER_UNLOCKED;
+static tb_usage_t   s_usage;
+
+#if configGENERATE_RUN_TIME_STATS
+static TaskHandle_t s_idle_task[portNUM_PROCESSORS];
+
+static inline uint32_t idle_ticks(int core)     // Wraps, deltas only
 {
-    lv_init();
+    return (uint32_t)ulTaskGetRunTimeCounter(s_idle_task[core]);
+}
+#endif
 
-    // Render-Buffer im schnellen internen RAM!
-    render_buf = (lv_color_t *)heap_caps_malloc(
-        DISP_WIDTH * BUF_LINES * sizeof(lv_color_t), 
-        MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA
-    );
+static void usage_init(void)
+{
+#if configGENERATE_RUN_TIME_STATS
+    for (int c = 0; c < portNUM_PROCESSORS; c++) s_idle_task[c] = xTaskGetIdleTaskHandleForCore(c);
+#else
+    ESP_LOGW(TAG, "CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS off, no per-core busy time");
+#endif
+}
 
-    lv_disp_draw_buf_init(&s_draw_buf,
-                           render_buf,               // Schneller interner Buffer
-                           NULL,
-                           DISP_WIDTH * BUF_LINES);  // Nicht full-frame!
+/**
+ * Close the current window once per second (called from the LVGL task)
+ */
+static void usage_update(void)
+{
+    static int64_t t_last = 0;
+    static pipeline_stats_t last;
+    static uint32_t vsync_last;
+#if configGENERATE_RUN_TIME_STATS
+    static uint32_t idle_last[portNUM_PROCESSORS];
+#endif
 
-    lv_disp_drv_init(&s_disp_drv);
-    s_disp_drv.hor_res = DISP_WIDTH;
-    s_disp_drv.ver_res = DISP_HEIGHT;
-    s_disp_drv.flush_cb = lvgl_flush_cb;
-    s_disp_drv.draw_buf = &s_draw_buf;
-    
-    // KEIN direct_mode → LVGL rendert in den kleinen internen Buffer
-    s_disp_drv.direct_mode = 0;
-    s_disp_drv.full_refresh = 0;
+    int64_t now = esp_timer_get_time();
+    if (t_last == 0) {
+        t_last = now;
+        last = s_stats;
+        vsync_last = s_vsync_count;
+#if configGENERATE_RUN_TIME_STATS
+        for (int c = 0; c < portNUM_PROCESSORS; c++) idle_last[c] = idle_ticks(c);
+#endif
+        return;
+    }
+    if (now - t_last < 1000000) return;
 
-    lv_disp_drv_register(&s_disp_drv);
+    tb_usage_t u = {
+        .window_us       = (uint32_t)(now - t_last),
+        .frames          = s_stats.frames - last.frames,
+        .cpu_flush_bytes = (uint32_t)(s_stats.flush_bytes - last.flush_bytes),
+        .gdma_bytes      = (uint32_t)(s_stats.copy_bytes - last.copy_bytes),
+        .scanout_bytes   = (s_vsync_count - vsync_last) * FB_SIZE,
+        .copy_wait_us    = (uint32_t)(s_stats.copy_wait_us - last.copy_wait_us),
+    };
+    u.psram_bytes = u.cpu_flush_bytes + 2 * u.gdma_bytes + u.scanout_bytes;
+#if configGENERATE_RUN_TIME_STATS
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        uint32_t idle = idle_ticks(c);
+        uint32_t d = (idle - idle_last[c]) / USAGE_IDLE_TICKS_PER_US;
+        idle_last[c] = idle;
+        u.core_busy_pct[c] = (d >= u.window_us) ? 0 : 100 - (uint8_t)(100ULL * d / u.window_us);
+    }
+#endif
+
+    t_last = now;
+    last = s_stats;
+    vsync_last = s_vsync_count;
+
+    portENTER_CRITICAL(&s_usage_lock);
+    s_usage = u;
+    portEXIT_CRITICAL(&s_usage_lock);
+}
+
+void tb_get_usage(tb_usage_t *out)
+{
+    portENTER_CRITICAL(&s_usage_lock);
+    *out = s_usage;
+    portEXIT_CRITICAL(&s_usage_lock);
+}
+
+static void usage_log(void)
+{
+    tb_usage_t u;
+    tb_get_usage(&u);
+    float s = u.window_us / 1e6f;
+    if (s <= 0) return;
+    ESP_LOGI(TAG, "Usage: flush %.1f MB/s, GDMA %.1f MB/s, scanout %.1f MB/s, PSRAM %.1f MB/s "
+             "(%.0f%% of plan), copy wait %.0f%%, busy core0 %u%% core1 %u%%",
+             u.cpu_flush_bytes / 1e6f / s, u.gdma_bytes / 1e6f / s, u.scanout_bytes / 1e6f / s,
+             u.psram_bytes / 1e6f / s, s_plan.psram_bw ? 100.0f * u.psram_bytes / s / s_plan.psram_bw : 0.0f,
+             100.0f * u.copy_wait_us / u.window_us,
+             u.core_busy_pct[0], u.core_busy_pct[1]);
 }
 
 /* ============================================================
  * LVGL Task
  * ============================================================ */
 
+// Time spent inside lv_timer_handler (render + flush, incl. copy wait)
+static uint64_t s_lvgl_busy_us = 0;
+
 static void lvgl_task(void *arg)
 {
     ESP_LOGI(TAG, "LVGL task started on core %d", xPortGetCoreID());
@@ -311,8 +5247,26 @@ static void lvgl_task(void *arg)
     TickType_t last_fps_tick = xTaskGetTickCount();
 
     while (1) {
+#if TOUCH_ENABLE
+        touch_poll();
+#endif
+#if FLUSH_RECORD_ENABLE
+        flush_log_poll();
+#endif
         // LVGL timer handler - renders dirty areas into the Work Buffer
+        int64_t t0 = esp_timer_get_time();
         uint32_t time_till_next = lv_timer_handler();
+        s_lvgl_busy_us += esp_timer_get_time() - t0;
+        usage_update();
+#if DAMAGE_SCHED_ENABLE
+        damage_sched_poll();
+#endif
+#if IMGC_ENABLE
+        imgc_poll();
+#endif
+#if ASSET_ENABLE
+        assets_poll();
+#endif
         
         // FPS logging every 5 seconds
         frame_count++;
@@ -320,15 +5274,61 @@ static void lvgl_task(void *arg)
         if ((now - last_fps_tick) >= pdMS_TO_TICKS(5000)) {
             float fps = (float)frame_count / 5.0f;
             ESP_LOGI(TAG, "FPS: %.1f", fps);
+            usage_log();
+            gdma_log();
+#if HUD_ENABLE
+            ESP_LOGI(TAG, "HUD: %d px/frame, %u us/frame", HUD_W * HUD_H, (unsigned)s_hud.draw_us);
+#endif
+#if PROF_ENABLE
+            prof_report();
+#endif
+#if LVMEM_ENABLE
+            lvmem_log();
+#endif
+#if GLYPH_CACHE_ENABLE
+            glyph_cache_log();
+#endif
+#if IMG_DECODER_ENABLE
+            img_log();
+#endif
+#if IMGC_ENABLE
+            imgc_log();
+#endif
+#if FLASH_SAFE_ENABLE
+            flash_safe_log();
+#endif
+#if ASSET_ENABLE
+            assets_log();
+#endif
+#if TOUCH_ENABLE
+            touch_log();
+#endif
+#if DAMAGE_SCHED_ENABLE
+            damage_sched_log();
+#endif
+#if VBLANK_PATCH_ENABLE
+            vblank_log();
+#endif
             frame_count = 0;
             last_fps_tick = now;
         }
 
+#if TRACE_ENABLE
+        if (!s_trace_stopped && esp_timer_get_time() >= TRACE_DUMP_MS * 1000LL) {
+            trace_dump_json();
+        }
+#endif
+
         // LVGL wants to be called again in time_till_next ms
         // Minimum 1ms, maximum 10ms for smooth animations
         uint32_t delay = (time_till_next < 1) ? 1 : 
                          (time_till_next > 10) ? 10 : time_till_next;
+#if TOUCH_ENABLE
+        // A touch event ends the wait early (touch_task notifies)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delay));
+#else
         vTaskDelay(pdMS_TO_TICKS(delay));
+#endif
     }
 }
 
@@ -345,13 +5345,673 @@ static void create_demo_ui(void)
     lv_obj_t *label = lv_label_create(scr);
     lv_label_set_text(label, "Triple Buffer Test");
     lv_obj_set_style_text_color(label, lv_color_white(), 0);
-    lv_obj_set_style_text_font(label, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_font(label, tb_glyph_cache_font(&lv_font_montserrat_24), 0);
     lv_obj_center(label);
 
     // TODO: Add your rotating pointer (50x360) here
     // e.g. using lv_img + lv_img_set_angle() animation
 }
 
+/* ============================================================
+ * Scenario Benchmark
+ * ============================================================ */
+
+#if BENCH_ENABLE
+
+/*
+ * Scripted workloads that are representative for our UIs. Each scene
+ * runs for BENCH_SCENE_MS, then one result line is printed:
+ *
+ *   BENCH {"scene":"pointer","frames":...,"p50_us":...,...}
+ *
+ * The lines are machine-readable (grep '^BENCH ' | cut -c7-) and are
+ * compared against the baseline stored in NVS. The first run, or a run
+ * with BENCH_SAVE_BASELINE = 1, stores its results as the new baseline.
+ */
+
+typedef void (*bench_setup_fn_t)(lv_obj_t *scr);
+
+typedef struct {
+    const char      *name;
+    bench_setup_fn_t setup;
+} bench_scene_t;
+
+// Stored per scene in NVS ("bench" namespace, key = scene name)
+typedef struct {
+    uint32_t p95_us;
+    float    fps;
+} bench_baseline_t;
+
+static struct {
+    int          scene;             // Index into s_bench_scenes, -1 = done
+    int64_t      scene_start_us;
+    int64_t      last_present_us;
+    uint32_t     n_samples;
+    uint32_t     samples[BENCH_MAX_FRAMES];  // Frame intervals in µs
+    pipeline_stats_t stats_start;
+    uint64_t     busy_start_us;
+    lv_img_dsc_t pointer_img;
+    lv_obj_t    *objs[64];          // Scene-owned objects for the scripts
+    uint32_t     n_objs;
+    lv_timer_t  *scene_timer;       // Script timer of the running scene
+    uint32_t     tick;
+#if HYBRID_FB_ENABLE
+    uint32_t     band_scan_start;
+#endif
+} s_bench = { .scene = -1 };
+
+static void bench_on_present(int64_t now_us)
+{
+    if (s_bench.scene < 0) return;
+    if (s_bench.last_present_us && s_bench.n_samples < BENCH_MAX_FRAMES) {
+        s_bench.samples[s_bench.n_samples++] = (uint32_t)(now_us - s_bench.last_present_us);
+    }
+    s_bench.last_present_us = now_us;
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t bench_percentile(const uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+    if (n == 0) return 0;
+    uint32_t idx = (n * pct + 99) / 100;
+    return sorted[(idx == 0) ? 0 : idx - 1];
+}
+
+// --- Scene: rotating 50x360 pointer ---------------------------------------
+
+static void bench_pointer_angle_cb(void *obj, int32_t v)
+{
+    lv_img_set_angle((lv_obj_t *)obj, (int16_t)v);
+}
+
+static void bench_setup_pointer(lv_obj_t *scr)
+{
+    lv_img_dsc_t *img = &s_bench.pointer_img;
+    if (!img->data) {
+        // Procedural needle: tapered, anti-aliased edges via the alpha byte
+        const int w = 50, h = 360;
+        uint8_t *px = heap_caps_malloc(w * h * LV_IMG_PX_SIZE_ALPHA_BYTE, MALLOC_CAP_SPIRAM);
+        if (!px) return;
+        for (int y = 0; y < h; y++) {
+            int half = 2 + (w / 2 - 2) * y / h;
+            for (int x = 0; x < w; x++) {
+                int d = abs(x - w / 2);
+                uint8_t a = (d < half) ? 255 : (d == half) ? 128 : 0;
+                lv_color_t c = lv_color_make(255, 40 + y / 2, 0);
+                uint8_t *p = px + (y * w + x) * LV_IMG_PX_SIZE_ALPHA_BYTE;
+                p[0] = c.full & 0xFF;
+                p[1] = c.full >> 8;
+                p[2] = a;
+            }
+        }
+        img->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        img->header.w = w;
+        img->header.h = h;
+        img->data_size = w * h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+        img->data = px;
+        tb_asset_register(img, "bench_pointer");
+    }
+
+    lv_obj_t *needle = lv_img_create(scr);
+    lv_img_set_src(needle, img);
+    lv_obj_align(needle, LV_ALIGN_CENTER, 0, -180);
+    lv_img_set_pivot(needle, 25, 360);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, needle);
+    lv_anim_set_exec_cb(&a, bench_pointer_angle_cb);
+    lv_anim_set_values(&a, 0, 3600);
+    lv_anim_set_time(&a, 4000);
+    lv_anim_set_path_cb(&a, lv_anim_path_linear);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+}
+
+#if ASSET_ENABLE
+/**
+ * The pointer again after a rebalance on the profile of the "pointer"
+ * scene: its data then comes from internal RAM
+ */
+static void bench_setup_pointer_hot(lv_obj_t *scr)
+{
+    tb_assets_rebalance();
+    bench_setup_pointer(scr);
+}
+#endif
+
+// --- Scene: the pointer during a sustained flash write ---------------------
+
+/**
+ * Erases and rewrites the "benchscr" scratch partition sector by sector,
+ * as an OTA would, for as long as its scene runs (core 0)
+ */
+static void bench_flash_writer_task(void *arg)
+{
+    const esp_partition_t *part = arg;
+    const int scene = s_bench.scene;
+    static uint8_t sector[4096];
+    memset(sector, 0xA5, sizeof(sector));
+
+    uint32_t bytes = 0;
+    size_t off = 0;
+    int64_t t0 = esp_timer_get_time();
+    while (s_bench.scene == scene) {
+        tb_flash_op_begin();
+        esp_partition_erase_range(part, off, sizeof(sector));
+        esp_partition_write(part, off, sector, sizeof(sector));
+        tb_flash_op_end();
+        bytes += sizeof(sector);
+        off = (off + sizeof(sector)) % part->size;
+        vTaskDelay(1);
+    }
+    ESP_LOGI(TAG, "Bench flash writer: %u KB in %u ms", (unsigned)(bytes / 1024),
+             (unsigned)((esp_timer_get_time() - t0) / 1000));
+    vTaskDelete(NULL);
+}
+
+static void bench_setup_flash_write(lv_obj_t *scr)
+{
+    bench_setup_pointer(scr);
+    // A partition of its own: the writes destroy whatever is stored there
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "benchscr");
+    if (!part) {
+        ESP_LOGW(TAG, "Bench flash_write: no \"benchscr\" partition, running without writes");
+        return;
+    }
+    xTaskCreatePinnedToCore(bench_flash_writer_task, "bench_flash", 3072, (void *)part, 2, NULL, 0);
+}
+
+// --- Scene: 12 digit counters at 20 Hz ------------------------------------
+
+static void bench_digits_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    for (uint32_t i = 0; i < s_bench.n_objs; i++) {
+        lv_label_set_text_fmt(s_bench.objs[i], "%5u.%u",
+                              (unsigned)((s_bench.tick * (i + 1)) / 10 % 100000),
+                              (unsigned)((s_bench.tick * (i + 1)) % 10));
+    }
+}
+
+static void bench_setup_digits(lv_obj_t *scr)
+{
+    for (int i = 0; i < 12; i++) {
+        lv_obj_t *label = lv_label_create(scr);
+        lv_obj_set_style_text_color(label, lv_color_white(), 0);
+        lv_obj_set_style_text_font(label, tb_glyph_cache_font(&lv_font_montserrat_24), 0);
+        lv_obj_set_pos(label, 40 + (i % 3) * 220, 60 + (i / 3) * 160);
+        s_bench.objs[s_bench.n_objs++] = label;
+    }
+    s_bench.scene_timer = lv_timer_create(bench_digits_timer_cb, 50, NULL);
+}
+
+// --- Scene: the same counters as numeric readouts ------------------------
+
+static void bench_numeric_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    char txt[16];
+    for (uint32_t i = 0; i < s_bench.n_objs; i++) {
+        snprintf(txt, sizeof(txt), "%5u.%u",
+                 (unsigned)((s_bench.tick * (i + 1)) / 10 % 100000),
+                 (unsigned)((s_bench.tick * (i + 1)) % 10));
+        tb_numeric_set_text(s_bench.objs[i], txt);
+    }
+}
+
+static void bench_setup_numeric(lv_obj_t *scr)
+{
+    for (int i = 0; i < 12; i++) {
+        lv_obj_t *num = tb_numeric_create(scr, &lv_font_montserrat_24, 7, lv_color_white());
+        if (!num) return;
+        lv_obj_set_pos(num, 40 + (i % 3) * 220, 60 + (i / 3) * 160);
+        s_bench.objs[s_bench.n_objs++] = num;
+    }
+    s_bench.scene_timer = lv_timer_create(bench_numeric_timer_cb, 50, NULL);
+}
+
+// --- Scene: live traces, LVGL chart vs. strip chart -----------------------
+
+static void bench_chart_timer_cb(lv_timer_t *t)
+{
+    // Two samples per 5 ms tick = 400 samples/s per series
+    for (int k = 0; k < 2; k++) {
+        s_bench.tick++;
+        int16_t v[2] = {
+            lv_trigo_sin(s_bench.tick * 3 % 360) / 4,
+            lv_trigo_sin(s_bench.tick * 7 % 360) / 8 + lv_trigo_sin(s_bench.tick * 97 % 360) / 32,
+        };
+        if (t->user_data) {
+            lv_chart_series_t **ser = t->user_data;
+            lv_chart_set_next_value(s_bench.objs[0], ser[0], v[0]);
+            lv_chart_set_next_value(s_bench.objs[0], ser[1], v[1]);
+        } else {
+            tb_stripchart_push(s_bench.objs[0], v);
+        }
+    }
+}
+
+static void bench_setup_chart_lv(lv_obj_t *scr)
+{
+    static lv_chart_series_t *ser[2];
+    lv_obj_t *chart = lv_chart_create(scr);
+    lv_obj_set_size(chart, DISP_WIDTH, 300);
+    lv_obj_set_pos(chart, 0, 210);
+    lv_chart_set_point_count(chart, DISP_WIDTH / 2);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, -10000, 10000);
+    ser[0] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_GREEN), LV_CHART_AXIS_PRIMARY_Y);
+    ser[1] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_CYAN), LV_CHART_AXIS_PRIMARY_Y);
+    s_bench.objs[s_bench.n_objs++] = chart;
+    s_bench.scene_timer = lv_timer_create(bench_chart_timer_cb, 5, ser);
+}
+
+static void bench_setup_stripchart(lv_obj_t *scr)
+{
+    lv_obj_t *chart = tb_stripchart_create(scr, DISP_WIDTH, 300, 2, 2);
+    if (!chart) return;
+    lv_obj_set_pos(chart, 0, 210);
+    tb_stripchart_set_range(chart, -10000, 10000);
+    s_bench.objs[s_bench.n_objs++] = chart;
+    s_bench.scene_timer = lv_timer_create(bench_chart_timer_cb, 5, NULL);
+}
+
+// --- Scene: blinking cursor and status icon (vblank patches) ---------------
+
+static void bench_cursor_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    lv_obj_set_style_bg_opa(s_bench.objs[0], (s_bench.tick & 1) ? LV_OPA_TRANSP : LV_OPA_COVER, 0);
+    if (s_bench.tick % 4 == 0) {
+        static const int palette[] = { LV_PALETTE_GREEN, LV_PALETTE_YELLOW, LV_PALETTE_RED };
+        lv_obj_set_style_bg_color(s_bench.objs[1], lv_palette_main(palette[s_bench.tick / 4 % 3]), 0);
+    }
+}
+
+static void bench_setup_cursor(lv_obj_t *scr)
+{
+    lv_obj_t *label = lv_label_create(scr);
+    lv_label_set_text(label, "user@device:~$ ");
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_set_pos(label, 40, 340);
+
+    // Cursor 3x28 px mid-screen, status icon 16x16 px in the top rows
+    static const lv_area_t boxes[] = { { 230, 338, 232, 365 }, { 684, 4, 699, 19 } };
+    for (int i = 0; i < 2; i++) {
+        lv_obj_t *o = lv_obj_create(scr);
+        lv_obj_remove_style_all(o);
+        lv_obj_set_pos(o, boxes[i].x1, boxes[i].y1);
+        lv_obj_set_size(o, lv_area_get_width(&boxes[i]), lv_area_get_height(&boxes[i]));
+        lv_obj_set_style_bg_color(o, lv_color_white(), 0);
+        lv_obj_set_style_bg_opa(o, LV_OPA_COVER, 0);
+        s_bench.objs[s_bench.n_objs++] = o;
+    }
+    s_bench.scene_timer = lv_timer_create(bench_cursor_timer_cb, 250, NULL);
+}
+
+// --- Scene: scrolling list ------------------------------------------------
+
+static void bench_list_scroll_cb(void *obj, int32_t v)
+{
+    lv_obj_scroll_to_y((lv_obj_t *)obj, v, LV_ANIM_OFF);
+}
+
+static void bench_setup_list(lv_obj_t *scr)
+{
+    lv_obj_t *list = lv_list_create(scr);
+    lv_obj_set_size(list, DISP_WIDTH, DISP_HEIGHT);
+    for (int i = 0; i < 60; i++) {
+        char txt[24];
+        snprintf(txt, sizeof(txt), "List entry %d", i);
+        lv_list_add_btn(list, NULL, txt);
+    }
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, list);
+    lv_anim_set_exec_cb(&a, bench_list_scroll_cb);
+    lv_anim_set_values(&a, 0, 2000);
+    lv_anim_set_time(&a, 3000);
+    lv_anim_set_playback_time(&a, 3000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+}
+
+#if TOUCH_ENABLE
+/**
+ * The list again, dragged by a replayed swipe (press, 300 ms up, release,
+ * 400 ms pause) through the touch path instead of an animation
+ */
+static void bench_setup_touch_scroll(lv_obj_t *scr)
+{
+    static tb_touch_sample_t swipe[32];
+    const int n = 30;
+    for (int i = 0; i < n; i++) {
+        swipe[i] = (tb_touch_sample_t){
+            .t_ms = 400 + i * 10, .x = DISP_WIDTH / 2, .y = 600 - i * 15, .pressed = true,
+        };
+    }
+    swipe[n] = swipe[n - 1];
+    swipe[n].t_ms += 10;
+    swipe[n].pressed = false;
+
+    lv_obj_t *list = lv_list_create(scr);
+    lv_obj_set_size(list, DISP_WIDTH, DISP_HEIGHT);
+    for (int i = 0; i < 60; i++) {
+        char txt[24];
+        snprintf(txt, sizeof(txt), "List entry %d", i);
+        lv_list_add_btn(list, NULL, txt);
+    }
+    tb_touch_replay(swipe, n + 1, true);
+}
+#endif
+
+#if DAMAGE_SCHED_ENABLE
+// --- Scene: pointer over a band of busy, deferrable widgets ---------------
+
+static void bench_overload_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    for (uint32_t i = 1; i < s_bench.n_objs; i++) {
+        lv_bar_set_value(s_bench.objs[i], (s_bench.tick * 7 + i * 13) % 100, LV_ANIM_OFF);
+    }
+    lv_obj_set_style_bg_color(s_bench.objs[0], lv_color_hsv_to_rgb(s_bench.tick * 5 % 360, 80, 60), 0);
+}
+
+/**
+ * The pointer (critical) above a 720x160 panel that changes color and 24
+ * bars (all deferrable) every 10 ms: more damage than the budget allows
+ */
+static void bench_setup_overload(lv_obj_t *scr)
+{
+    lv_obj_t *panel = lv_obj_create(scr);
+    lv_obj_set_size(panel, DISP_WIDTH, 160);
+    lv_obj_set_pos(panel, 0, DISP_HEIGHT - 160);
+    tb_damage_set_priority(panel, TB_PRIO_DEFERRABLE);
+    s_bench.objs[s_bench.n_objs++] = panel;
+    for (int i = 0; i < 24; i++) {
+        lv_obj_t *bar = lv_bar_create(panel);
+        lv_obj_set_size(bar, 100, 16);
+        lv_obj_set_pos(bar, 10 + (i % 6) * 115, 10 + (i / 6) * 34);
+        s_bench.objs[s_bench.n_objs++] = bar;
+    }
+    s_bench.scene_timer = lv_timer_create(bench_overload_timer_cb, 10, NULL);
+
+    bench_setup_pointer(scr);
+    tb_damage_set_priority(lv_obj_get_child(scr, -1), TB_PRIO_CRITICAL);
+}
+#endif
+
+// --- Scene: full-screen fade ----------------------------------------------
+
+static void bench_fade_cb(void *obj, int32_t v)
+{
+    lv_obj_set_style_bg_opa((lv_obj_t *)obj, (lv_opa_t)v, 0);
+}
+
+static void bench_setup_fade(lv_obj_t *scr)
+{
+    lv_obj_t *overlay = lv_obj_create(scr);
+    lv_obj_set_size(overlay, DISP_WIDTH, DISP_HEIGHT);
+    lv_obj_center(overlay);
+    lv_obj_set_style_border_width(overlay, 0, 0);
+    lv_obj_set_style_radius(overlay, 0, 0);
+    lv_obj_set_style_bg_color(overlay, lv_palette_main(LV_PALETTE_BLUE), 0);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, overlay);
+    lv_anim_set_exec_cb(&a, bench_fade_cb);
+    lv_anim_set_values(&a, LV_OPA_TRANSP, LV_OPA_COVER);
+    lv_anim_set_time(&a, 1000);
+    lv_anim_set_playback_time(&a, 1000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+}
+
+// --- Scene: many small widgets --------------------------------------------
+
+static void bench_widgets_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    // Touch a few widgets per tick, like status LEDs and level bars do
+    for (uint32_t i = s_bench.tick % 4; i < s_bench.n_objs; i += 4) {
+        if (i % 2) lv_led_toggle(s_bench.objs[i]);
+        else lv_bar_set_value(s_bench.objs[i], (s_bench.tick * 7 + i * 13) % 100, LV_ANIM_OFF);
+    }
+}
+
+static void bench_setup_widgets(lv_obj_t *scr)
+{
+    for (int i = 0; i < 64; i++) {
+        lv_obj_t *obj;
+        if (i % 2) {
+            obj = lv_led_create(scr);
+            lv_obj_set_size(obj, 24, 24);
+        } else {
+            obj = lv_bar_create(scr);
+            lv_obj_set_size(obj, 60, 12);
+        }
+        lv_obj_set_pos(obj, 20 + (i % 8) * 86, 30 + (i / 8) * 84);
+        s_bench.objs[s_bench.n_objs++] = obj;
+    }
+    s_bench.scene_timer = lv_timer_create(bench_widgets_timer_cb, 100, NULL);
+}
+
+// --- Scene: mostly idle screen --------------------------------------------
+
+static void bench_idle_timer_cb(lv_timer_t *t)
+{
+    s_bench.tick++;
+    lv_label_set_text_fmt(s_bench.objs[0], "%02u:%02u",
+                          (unsigned)(s_bench.tick / 60 % 60), (unsigned)(s_bench.tick % 60));
+}
+
+static void bench_setup_idle(lv_obj_t *scr)
+{
+    lv_obj_t *label = lv_label_create(scr);
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_set_style_text_font(label, tb_glyph_cache_font(&lv_font_montserrat_24), 0);
+    lv_obj_center(label);
+    s_bench.objs[s_bench.n_objs++] = label;
+    // A clock that changes once per second, nothing else
+    s_bench.scene_timer = lv_timer_create(bench_idle_timer_cb, 1000, NULL);
+}
+
+static const bench_scene_t s_bench_scenes[] = {
+    { "pointer", bench_setup_pointer },
+#if ASSET_ENABLE
+    { "pointer_hot", bench_setup_pointer_hot },
+#endif
+    { "flash_write", bench_setup_flash_write },
+    { "digits",  bench_setup_digits  },
+    { "numeric", bench_setup_numeric },
+    { "chart_lv", bench_setup_chart_lv },
+    { "stripchart", bench_setup_stripchart },
+    { "cursor", bench_setup_cursor },
+    { "list",    bench_setup_list    },
+#if TOUCH_ENABLE
+    { "touch_scroll", bench_setup_touch_scroll },
+#endif
+#if DAMAGE_SCHED_ENABLE
+    { "overload", bench_setup_overload },
+#endif
+    { "fade",    bench_setup_fade    },
+    { "widgets", bench_setup_widgets },
+    { "idle",    bench_setup_idle    },
+};
+#define BENCH_NUM_SCENES (sizeof(s_bench_scenes) / sizeof(s_bench_scenes[0]))
+
+// --- Runner ---------------------------------------------------------------
+
+static void bench_report(const bench_scene_t *scene, int64_t now_us)
+{
+    uint32_t n = s_bench.n_samples;
+    qsort(s_bench.samples, n, sizeof(uint32_t), bench_cmp_u32);
+
+    float dur_s = (now_us - s_bench.scene_start_us) / 1e6f;
+    uint32_t frames = s_stats.frames - s_bench.stats_start.frames;
+    uint64_t bytes = (s_stats.flush_bytes - s_bench.stats_start.flush_bytes) +
+                     (s_stats.copy_bytes - s_bench.stats_start.copy_bytes);
+    // Busy = inside lv_timer_handler, minus the time blocked on GDMA
+    uint64_t busy = (s_lvgl_busy_us - s_bench.busy_start_us) -
+                    (s_stats.copy_wait_us - s_bench.stats_start.copy_wait_us);
+
+    bench_baseline_t cur = {
+        .p95_us = bench_percentile(s_bench.samples, n, 95),
+        .fps    = frames / dur_s,
+    };
+
+    // Compare against (and optionally store) the baseline in NVS
+    bench_baseline_t base = { 0 };
+    size_t len = sizeof(base);
+    nvs_handle_t nvs;
+    bool have_base = false;
+    tb_flash_op_begin();
+    if (nvs_open("bench", NVS_READWRITE, &nvs) == ESP_OK) {
+        have_base = (nvs_get_blob(nvs, scene->name, &base, &len) == ESP_OK &&
+                     len == sizeof(base));
+        if (!have_base || BENCH_SAVE_BASELINE) {
+            nvs_set_blob(nvs, scene->name, &cur, sizeof(cur));
+            nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    tb_flash_op_end();
+
+    printf("BENCH {\"scene\":\"%s\",\"frames\":%u,\"p50_us\":%u,\"p95_us\":%u,"
+           "\"p99_us\":%u,\"max_us\":%u,\"fps\":%.2f,\"bytes_copied\":%llu,"
+           "\"cpu_busy_us\":%llu,\"cpu_busy_pct\":%.1f",
+           scene->name, (unsigned)frames,
+           (unsigned)bench_percentile(s_bench.samples, n, 50), (unsigned)cur.p95_us,
+           (unsigned)bench_percentile(s_bench.samples, n, 99),
+           (unsigned)(n ? s_bench.samples[n - 1] : 0), cur.fps,
+           (unsigned long long)bytes, (unsigned long long)busy,
+           100.0f * busy / (dur_s * 1e6f));
+#if HYBRID_FB_ENABLE
+    // PSRAM traffic the band took over: flush, copy and scanout
+    printf(",\"psram_saved\":%llu",
+           (unsigned long long)((s_stats.band_bytes - s_bench.stats_start.band_bytes) +
+                                (uint32_t)(s_band_scan_bytes - s_bench.band_scan_start)));
+#endif
+    if (have_base) {
+        printf(",\"base_fps\":%.2f,\"base_p95_us\":%u,\"fps_delta_pct\":%.1f,\"p95_delta_pct\":%.1f",
+               base.fps, (unsigned)base.p95_us,
+               base.fps > 0 ? 100.0f * (cur.fps - base.fps) / base.fps : 0.0f,
+               base.p95_us ? 100.0f * ((float)cur.p95_us - base.p95_us) / base.p95_us : 0.0f);
+    }
+    printf("}\n");
+}
+
+static void bench_start_scene(int idx)
+{
+    lv_obj_t *scr = lv_scr_act();
+    if (s_bench.scene_timer) {
+        lv_timer_del(s_bench.scene_timer);
+        s_bench.scene_timer = NULL;
+    }
+    lv_anim_del(NULL, NULL);
+#if TOUCH_ENABLE
+    tb_touch_replay(NULL, 0, false);
+#endif
+    lv_obj_clean(scr);
+    lv_obj_set_style_bg_color(scr, lv_color_black(), 0);
+    s_bench.n_objs = 0;
+    s_bench.tick = 0;
+
+    s_bench.scene = idx;
+    if (idx < 0) return;
+
+    s_bench_scenes[idx].setup(scr);
+    s_bench.n_samples = 0;
+    s_bench.last_present_us = 0;
+    s_bench.stats_start = s_stats;
+    s_bench.busy_start_us = s_lvgl_busy_us;
+#if HYBRID_FB_ENABLE
+    s_bench.band_scan_start = s_band_scan_bytes;
+#endif
+    s_bench.scene_start_us = esp_timer_get_time();
+}
+
+static void bench_timer_cb(lv_timer_t *t)
+{
+    int64_t now = esp_timer_get_time();
+    if (now - s_bench.scene_start_us < BENCH_SCENE_MS * 1000LL) return;
+
+    bench_report(&s_bench_scenes[s_bench.scene], now);
+
+    int next = s_bench.scene + 1;
+    if (next >= (int)BENCH_NUM_SCENES) {
+        bench_start_scene(-1);
+        lv_timer_del(t);
+        ESP_LOGI(TAG, "Benchmark finished");
+        return;
+    }
+    bench_start_scene(next);
+}
+
+/**
+ * Screen create / destroy churn: allocator speed and fragmentation
+ */
+static void bench_mem_churn(void)
+{
+    const int cycles = 50;
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < cycles; i++) {
+        lv_obj_t *scr = lv_obj_create(NULL);
+        for (int k = 0; k < 40; k++) {
+            lv_obj_t *btn = lv_btn_create(scr);
+            lv_obj_t *label = lv_label_create(btn);
+            lv_label_set_text_fmt(label, "Button %d/%d", i, k);
+            lv_obj_t *bar = lv_bar_create(scr);
+            lv_bar_set_value(bar, k, LV_ANIM_OFF);
+        }
+        lv_obj_del(scr);
+    }
+    uint32_t us = (uint32_t)((esp_timer_get_time() - t0) / cycles);
+
+    printf("BENCH {\"scene\":\"mem_churn\",\"cycles\":%d,\"us_per_cycle\":%u", cycles, (unsigned)us);
+#if LVMEM_ENABLE
+    tb_lvmem_stats_t st;
+    tb_lvmem_get_stats(&st);
+    uint32_t allocs = st.heap.allocs + st.psram.allocs;
+    for (int c = 0; c < TB_LVMEM_CLASSES; c++) allocs += st.cls[c].allocs;
+    printf(",\"allocs\":%u,\"tlsf_frag_pct\":%u,\"tlsf_high_water\":%u,\"psram_high_water\":%u",
+           (unsigned)allocs, (unsigned)st.heap_frag_pct, (unsigned)st.heap.bytes_high_water,
+           (unsigned)st.psram.bytes_high_water);
+#endif
+    printf("}\n");
+}
+
+/**
+ * Run all scenes one after another (called instead of create_demo_ui)
+ */
+static void run_benchmark(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS unavailable (0x%x), no baseline comparison", ret);
+    }
+
+    ESP_LOGI(TAG, "Benchmark: %d scenes x %d ms", (int)BENCH_NUM_SCENES, BENCH_SCENE_MS);
+    bench_mem_churn();
+    bench_start_scene(0);
+    lv_timer_create(bench_timer_cb, 100, NULL);
+}
+
+#endif // BENCH_ENABLE
+
 /* ============================================================
  * Main
  * ============================================================ */
@@ -365,24 +6025,76 @@ void app_main(void)
 
     // 1. Allocate buffers
     ESP_ERROR_CHECK(allocate_buffers());
+#if SNAPSHOT_ENABLE
+    // Woken from deep sleep → show the last frame right away
+    snapshot_restore(front_buf);
+#endif
 
     // 2. Initialize GDMA
     ESP_ERROR_CHECK(gdma_copy_init());
+    s_front_pin = xSemaphoreCreateMutex();
+#if VBLANK_PATCH_ENABLE
+    s_vblank.sem = xSemaphoreCreateBinary();
+#endif
+#if FLASH_SAFE_ENABLE
+    s_flash_gate = xSemaphoreCreateRecursiveMutex();
+#endif
+
+#if FLUSH_RECORD_ENABLE
+    ESP_ERROR_CHECK(flush_log_init());
+#endif
+
+#if CALIB_ENABLE
+    // Tuned parameters from NVS, else measure before scanout adds traffic
+    const bool calibrate = !calib_load();
+    if (calibrate) calib_measure_copy();
+#endif
 
     // 3. Initialize LCD panel
     ESP_ERROR_CHECK(lcd_panel_init());
+#if CALIB_ENABLE
+    if (calibrate) calib_measure_scanout();
+#endif
 
     // 4. Display first frame (black)
+#if !SCANOUT_BOUNCE
     esp_lcd_panel_draw_bitmap(s_panel_handle, 0, 0, DISP_WIDTH, DISP_HEIGHT, front_buf);
+#endif
+
+#if FLUSH_REPLAY_ENABLE
+    // Replay a recorded flush stream, no LVGL and no application
+    xTaskCreatePinnedToCore(flush_replay_task, "replay", 4096, NULL, 5, NULL, 1);
+    return;
+#endif
 
     // 5. Initialize LVGL
     lvgl_display_init();
+#if TOUCH_ENABLE
+    touch_init();
+#endif
 
     // 6. Create demo UI
     create_demo_ui();
+#if CALIB_ENABLE
+    if (calibrate) {
+        calib_measure_strips();     // Renders the demo UI a few dozen times
+        calib_save();
+    }
+    calib_log();
+#endif
+#if BENCH_ENABLE
+    run_benchmark();    // Replaces the demo screen with the scripted scenes
+#endif
+
+    // 7. Idle task run time for CPU utilization
+    usage_init();
 
-    // 7. Start LVGL task (Core 1, so Core 0 stays free)
+    // 8. Start LVGL task (Core 1, so Core 0 stays free)
+#if TOUCH_ENABLE
+    xTaskCreatePinnedToCore(lvgl_task, "lvgl", 8192, NULL, 5, &s_touch.lvgl_task, 1);
+#else
     xTaskCreatePinnedToCore(lvgl_task, "lvgl", 8192, NULL, 5, NULL, 1);
+#endif
 
     ESP_LOGI(TAG, "System running!");
 }
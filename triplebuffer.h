@@ -0,0 +1,499 @@
+/**
+ * Triple-Buffer LVGL Display Driver for ESP32-S3 - Application API
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================
+ * Front Buffer Access
+ * ============================================================ */
+
+#define TB_DISP_WIDTH   720
+#define TB_DISP_HEIGHT  720
+
+/**
+ * Called from the LVGL task right after every swap, with the new
+ * generation and Front Buffer (TB_DISP_WIDTH x TB_DISP_HEIGHT RGB565).
+ * Must return quickly, it runs inside the render pipeline.
+ */
+typedef void (*tb_swap_cb_t)(uint32_t generation, const uint16_t *front, void *ctx);
+
+/**
+ * Number of swaps so far; changes exactly when the Front Buffer changes
+ */
+uint32_t tb_front_generation(void);
+
+/**
+ * Current Front Buffer, read in place without copying. The contents are
+ * only guaranteed to be that frame while tb_front_generation() still
+ * returns *generation; check it again after reading. With HYBRID_FB_ENABLE
+ * the band rows are only current inside the swap callback or while pinned.
+ */
+const uint16_t *tb_front_buffer(uint32_t *generation);
+
+/**
+ * Install (or remove with NULL) the swap callback
+ */
+void tb_set_swap_callback(tb_swap_cb_t cb, void *ctx);
+
+/* ============================================================
+ * Screenshot / Remote View
+ * ============================================================ */
+
+/**
+ * Byte sink for screenshots and the remote-view stream (UART, USB CDC,
+ * file, socket ...). write() returns 0 on success; a failed write makes
+ * the stream resend a keyframe.
+ */
+typedef struct {
+    int  (*write)(void *ctx, const void *data, size_t len);
+    void  *ctx;
+} tb_stream_sink_t;
+
+typedef struct {
+    uint32_t packets;           // Packets written (keyframes + deltas)
+    uint32_t keyframes;
+    uint64_t bytes;             // Total bytes written
+    uint64_t encode_us;         // Total encode time (Front Buffer pinned)
+    uint32_t last_bytes;        // Size of the last packet
+    uint32_t last_encode_us;    // Encode time of the last packet
+} tb_stream_stats_t;
+
+/**
+ * Keep the Front Buffer from being swapped while reading it. Blocks the
+ * render pipeline for as long as it is held, so keep it short.
+ */
+void tb_front_pin(void);
+void tb_front_unpin(void);
+
+/**
+ * Write one RLE keyframe packet of the current Front Buffer to sink.
+ * Encoded in pinned row bands; if the frame changes meanwhile it is
+ * encoded again, and after a few tries the bands may span frames.
+ */
+esp_err_t tb_screenshot(const tb_stream_sink_t *sink);
+
+/**
+ * Start streaming (STREAM_ENABLE): a keyframe, then one packet per
+ * presented frame with its damaged rectangles
+ */
+esp_err_t tb_stream_start(const tb_stream_sink_t *sink);
+
+void tb_stream_get_stats(tb_stream_stats_t *out);
+
+/* ============================================================
+ * Flash-Safe Display (FLASH_SAFE_ENABLE)
+ * ============================================================ */
+
+/**
+ * Bracket flash writes (NVS commits, OTA chunks) with these: no GDMA copy
+ * starts in between, the scanout keeps repeating its last lines while the
+ * cache is off. Nestable, any task. No-ops when the mode is disabled.
+ */
+void tb_flash_op_begin(void);
+void tb_flash_op_end(void);
+
+/* ============================================================
+ * Flush Recording (FLUSH_RECORD_ENABLE)
+ * ============================================================ */
+
+/**
+ * End the flush recording and save it up to the last complete frame to the
+ * "flushlog" partition (done by the LVGL task before its next refresh).
+ * Without a call the log is saved after FLUSH_LOG_MAX_MS or when full.
+ */
+void tb_flush_log_stop(void);
+
+/* ============================================================
+ * Suspend / Resume (SNAPSHOT_ENABLE)
+ * ============================================================ */
+
+/**
+ * Compress the current Front Buffer into the "fbsnap" partition before
+ * esp_deep_sleep_start(). On success the display stays frozen on that
+ * frame; on error it keeps running. After the wake-up the frame is
+ * restored before LVGL starts.
+ */
+esp_err_t tb_display_suspend(void);
+
+/* ============================================================
+ * LVGL Memory Backend (LVMEM_ENABLE)
+ * ============================================================ */
+
+#define TB_LVMEM_CLASSES    5   // 16, 32, 64, 128, 256 bytes
+
+typedef struct {
+    uint32_t allocs;            // Successful allocations
+    uint32_t frees;
+    uint32_t in_use;            // Blocks currently allocated
+    uint32_t high_water;        // Max. blocks allocated at once
+    uint32_t bytes_in_use;
+    uint32_t bytes_high_water;
+    uint32_t spills;            // Requests passed on to the next tier
+} tb_lvmem_class_stats_t;
+
+typedef struct {
+    tb_lvmem_class_stats_t cls[TB_LVMEM_CLASSES];   // Internal RAM size classes
+    tb_lvmem_class_stats_t heap;                    // Internal RAM TLSF region
+    tb_lvmem_class_stats_t psram;                   // Large blocks in PSRAM
+    uint32_t heap_free;
+    uint32_t heap_largest_free;
+    uint8_t  heap_frag_pct;     // 100 - largest free block / total free
+} tb_lvmem_stats_t;
+
+/**
+ * LVGL allocator (LV_MEM_CUSTOM_ALLOC / _FREE / _REALLOC in lv_conf.h)
+ */
+void *tb_lv_malloc(size_t size);
+void  tb_lv_free(void *p);
+void *tb_lv_realloc(void *p, size_t size);
+
+void tb_lvmem_get_stats(tb_lvmem_stats_t *out);
+
+/* ============================================================
+ * Glyph Cache (GLYPH_CACHE_ENABLE)
+ * ============================================================ */
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint64_t hit_cycles;        // Bitmap lookup cost on hits
+    uint64_t miss_cycles;       // Fetch + decompress + A8 conversion on misses
+} tb_glyph_cache_stats_t;
+
+/**
+ * Font to use instead of font so its glyphs are drawn from the internal
+ * RAM atlas. Returns font itself when the cache is disabled or full.
+ */
+const lv_font_t *tb_glyph_cache_font(const lv_font_t *font);
+
+void tb_glyph_cache_get_stats(tb_glyph_cache_stats_t *out);
+
+/* ============================================================
+ * Image Assets (IMG_DECODER_ENABLE)
+ * ============================================================ */
+
+/*
+ * Blob written by tools/tb_imgconv.c, wrapped in an lv_img_dsc_t with
+ * cf = LV_IMG_CF_USER_ENCODED_0. Layout: header, color data (RGB565,
+ * raw or row-RLE), then with TB_IMG_F_ALPHA one A8 byte per pixel.
+ */
+#define TB_IMG_MAGIC        0x31494254u     // "TBI1"
+#define TB_IMG_F_ALPHA      0x01            // A8 plane after the color data
+#define TB_IMG_F_RLE        0x02            // Color data is RLE, rows encoded separately
+#define TB_IMG_F_SWAP       0x04            // RGB565 bytes swapped (LV_COLOR_16_SWAP)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t w;
+    uint16_t h;
+    uint32_t color_len;         // Bytes of color data after the header
+    uint8_t  flags;
+    uint8_t  reserved[3];
+    char     name[16];
+} tb_img_hdr_t;
+
+typedef struct {
+    const char *name;
+    uint32_t flash_bytes;       // Whole blob
+    uint32_t decoded_bytes;     // What LVGL draws from
+    uint32_t decodes;           // Opens (image cache misses)
+    uint32_t last_decode_us;
+    uint32_t total_decode_us;   // 0 for blobs LVGL reads in place
+} tb_img_stats_t;
+
+/**
+ * Copy the stats of up to max assets seen so far, returns the count
+ */
+int tb_img_get_stats(tb_img_stats_t *out, int max);
+
+/* ============================================================
+ * Decoded-Image Cache (IMGC_ENABLE)
+ * ============================================================ */
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t passed;            // Opens not cached (read in place, other formats)
+    uint32_t evictions;
+    uint32_t entries;
+    uint32_t bytes;
+    uint32_t bytes_high_water;
+    uint32_t budget;
+    uint64_t miss_us;           // Decode time on misses, i.e. saved per hit
+} tb_img_cache_stats_t;
+
+/**
+ * Keep the decoded src in the cache across screen changes (or release it)
+ */
+void tb_img_cache_pin(const void *src, bool pin);
+
+void tb_img_cache_get_stats(tb_img_cache_stats_t *out);
+
+/* ============================================================
+ * Asset Placement (ASSET_ENABLE)
+ * ============================================================ */
+
+typedef enum {
+    TB_ASSET_SOURCE,            // Where it was registered, e.g. flash
+    TB_ASSET_PSRAM,
+    TB_ASSET_INTERNAL,
+} tb_asset_tier_t;
+
+typedef struct {
+    const char     *name;
+    uint32_t        size;
+    tb_asset_tier_t tier;
+    uint32_t        draws;
+    uint64_t        bytes_read;     // Pixels read in place while drawing
+    uint64_t        draw_cycles;
+    uint32_t        score;          // Decaying KB read, drives placement
+} tb_asset_stats_t;
+
+/**
+ * Track an image for placement. img must be writable: its data pointer
+ * is redirected to the promoted copy. name (max. 15 chars) must stay valid.
+ */
+esp_err_t tb_asset_register(lv_img_dsc_t *img, const char *name);
+
+/**
+ * Re-place all assets by their profile (LVGL context only). Runs
+ * automatically on screen change.
+ */
+void tb_assets_rebalance(void);
+
+int tb_assets_get_stats(tb_asset_stats_t *out, int max);
+
+/* ============================================================
+ * Numeric Readout Widget
+ * ============================================================ */
+
+/**
+ * Fixed-width readout with n_cells character cells (max. 16) for
+ * "0123456789+-.: ". Updates redraw only the cells that changed.
+ */
+lv_obj_t *tb_numeric_create(lv_obj_t *parent, const lv_font_t *font, uint8_t n_cells, lv_color_t color);
+
+/**
+ * Set the text, right-aligned; characters outside the set stay blank
+ */
+void tb_numeric_set_text(lv_obj_t *obj, const char *txt);
+
+/**
+ * Set a fixed-point value, e.g. (1234, 1) → "123.4"
+ */
+void tb_numeric_set_value(lv_obj_t *obj, int32_t value, uint8_t decimals);
+
+/* ============================================================
+ * Vblank Patching
+ * ============================================================ */
+
+/**
+ * Frames patched into the Front Buffer during vblank (VBLANK_PATCH_ENABLE)
+ */
+typedef struct {
+    uint32_t patches;           // Frames presented without copy and swap
+    uint32_t patched_px;
+    uint32_t missed;            // Vsync came too late, full pipeline instead
+    uint32_t straddled;         // Area crossed the scanout read-ahead, full pipeline
+    uint32_t torn;              // Writes that ended after scanout read the area
+} tb_vblank_stats_t;
+
+void tb_vblank_get_stats(tb_vblank_stats_t *out);
+
+/* ============================================================
+ * Strip Chart Widget
+ * ============================================================ */
+
+/**
+ * Scrolling plot of n_series live traces, newest sample at the right
+ * edge, px_per_sample pixels apart. The background is the object's
+ * bg_color. Must be opaque and not covered by other objects: a push
+ * moves the old pixels in the framebuffer and only renders the new
+ * columns.
+ */
+lv_obj_t *tb_stripchart_create(lv_obj_t *parent, lv_coord_t w, lv_coord_t h,
+                               uint8_t n_series, uint8_t px_per_sample);
+
+void tb_stripchart_set_series_color(lv_obj_t *obj, uint8_t series, lv_color_t color);
+
+/**
+ * Value range mapped to the chart height (redraws the whole chart)
+ */
+void tb_stripchart_set_range(lv_obj_t *obj, int16_t min, int16_t max);
+
+/**
+ * Append one sample per series (values[n_series]); any rate, the cost
+ * per frame stays the same
+ */
+void tb_stripchart_push(lv_obj_t *obj, const int16_t *values);
+
+/* ============================================================
+ * Bandwidth / Utilization
+ * ============================================================ */
+
+/**
+ * Usage of the display pipeline during the last complete ~1 s window.
+ * All byte counters are per window, not cumulative.
+ */
+typedef struct {
+    uint32_t window_us;         // Length of the aggregation window
+    uint32_t frames;            // Presented frames (swaps)
+    uint32_t cpu_flush_bytes;   // CPU writes render_buf → work_buf
+    uint32_t gdma_bytes;        // Bytes copied by GDMA (read + written in PSRAM)
+    uint32_t scanout_bytes;     // Bytes read from PSRAM by LCD_CAM
+    uint32_t psram_bytes;       // Total PSRAM traffic of the three above
+    uint32_t copy_wait_us;      // LVGL task blocked on the GDMA completion
+    uint8_t  core_busy_pct[2];  // Per-core busy time (100% - idle task run time)
+} tb_usage_t;
+
+/**
+ * Copy the usage numbers of the last complete window (any task, any core)
+ */
+void tb_get_usage(tb_usage_t *out);
+
+/**
+ * GDMA copy watchdog: a copy past its deadline (size / measured rate) is
+ * a stall; the channels are reset and the CPU copies the rest
+ */
+typedef struct {
+    uint32_t stalls;            // Copies that missed their deadline
+    uint32_t recoveries;        // Stalls whose channels were stopped and reset
+    uint64_t cpu_bytes;         // Copied by CPU after a stall or failed start
+} tb_gdma_stats_t;
+
+void tb_gdma_get_stats(tb_gdma_stats_t *out);
+
+/**
+ * Panel timing and PSRAM budget chosen at init (bandwidth in bytes/s)
+ */
+typedef struct {
+    uint32_t pclk_hz;
+    uint16_t hpw, hbp, hfp;
+    uint16_t vpw, vbp, vfp;
+    uint16_t bounce_lines;      // 0 = scanout straight from PSRAM
+    float    refresh_hz;
+    uint32_t psram_bw;          // Usable PSRAM bandwidth
+    uint32_t scanout_bw;        // LCD_CAM at refresh_hz
+    uint32_t pipeline_bw;       // Flush + GDMA copy at the planned frame rate
+    int32_t  spare_bw;          // Left for everything else, < 0 = over budget
+    bool     feasible;
+} tb_timing_plan_t;
+
+const tb_timing_plan_t *tb_get_timing_plan(void);
+
+/* ============================================================
+ * Boot Calibration (CALIB_ENABLE)
+ * ============================================================ */
+
+/**
+ * Pipeline parameters measured at the first boot (rates in bytes/s)
+ */
+typedef struct {
+    uint32_t cpu_write_bw;      // CPU writes to PSRAM incl. cache write-back
+    uint32_t gdma_bw;           // GDMA PSRAM → PSRAM copy, no scanout
+    uint32_t gdma_scan_bw;      // Same while LCD_CAM scans out
+    uint32_t stall_us;          // Spread of 64 KB copies during scanout
+    uint32_t copy_crossover;    // Copies below this size are done by the CPU
+    uint32_t strip_us;          // Render + flush overhead per strip
+    uint16_t strip_lines;       // Render buffer height
+    uint16_t bounce_lines;      // Bounce buffer height that bridges stall_us
+} tb_calib_t;
+
+/**
+ * Parameters in use, NULL if not calibrated
+ */
+const tb_calib_t *tb_get_calibration(void);
+
+/**
+ * Drop the stored parameters and restart; the next boot measures again.
+ * Does nothing without CALIB_ENABLE.
+ */
+void tb_recalibrate(void);
+
+/* ============================================================
+ * Touch Input (TOUCH_ENABLE)
+ * ============================================================ */
+
+/**
+ * One touch sample of a recorded gesture, t_ms relative to its start
+ */
+typedef struct {
+    uint32_t t_ms;
+    int16_t  x, y;
+    bool     pressed;
+} tb_touch_sample_t;
+
+/**
+ * Replay samples instead of the touch controller (fed through the same
+ * queue, prediction and indev); loop restarts after samples[0].t_ms.
+ * The controller is ignored until stopped with samples = NULL.
+ */
+esp_err_t tb_touch_replay(const tb_touch_sample_t *samples, size_t n, bool loop);
+
+/**
+ * Record queued events into buf (NULL stops); returns the number of
+ * samples written into the previous buffer
+ */
+size_t tb_touch_record(tb_touch_sample_t *buf, size_t cap);
+
+typedef struct {
+    uint32_t events;            // Queued by the touch task
+    uint32_t dropped;           // Queue full
+    uint32_t read_errors;       // I2C failures
+    uint32_t latency_avg_us;    // Interrupt → vsync that shows the result
+    uint32_t latency_max_us;
+    uint16_t predict_avg_px;    // Mean extrapolation distance
+} tb_touch_stats_t;
+
+void tb_touch_get_stats(tb_touch_stats_t *out);
+
+/* ============================================================
+ * Damage Visualization (DAMAGE_VIS_ENABLE)
+ * ============================================================ */
+
+/**
+ * Print the per-tile damage frequency as CSV between
+ * HEATMAP_BEGIN <tile> <cols> <rows> <frames> and HEATMAP_END
+ */
+void tb_damage_dump_heatmap(void);
+
+/* ============================================================
+ * Damage Priorities (DAMAGE_SCHED_ENABLE)
+ * ============================================================ */
+
+typedef enum {
+    TB_PRIO_DEFERRABLE,         // May wait a few frames when over budget
+    TB_PRIO_NORMAL,             // Default, removes a hint
+    TB_PRIO_CRITICAL,           // Rendered first, never deferred
+} tb_damage_prio_t;
+
+/**
+ * Priority of the areas an object invalidates. Critical: any area that
+ * touches the object; deferrable: areas lying inside it.
+ */
+esp_err_t tb_damage_set_priority(lv_obj_t *obj, tb_damage_prio_t prio);
+
+typedef struct {
+    uint32_t frames_over;       // Frames that deferred something
+    uint32_t deferred_areas;
+    uint32_t forced_areas;      // Rendered after DAMAGE_DEFER_MAX frames
+    uint32_t critical_frames;   // Frames with critical damage
+    uint32_t critical_lat_avg_us;   // Render start → vsync that shows it
+    uint32_t critical_lat_max_us;
+} tb_damage_sched_stats_t;
+
+void tb_damage_sched_get_stats(tb_damage_sched_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif